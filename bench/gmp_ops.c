@@ -0,0 +1,101 @@
+/*
+ * Measures the cost of a single arithmetic operation on Gmp numbers.
+ *
+ * The same loop runs with plain lua numbers, with Gmp numbers backed by
+ * doubles (the default) and with Gmp numbers backed by mpfr (Gmp.precise =
+ * true). For each variant the time and the memory allocated by lua per
+ * operation are printed.
+ *
+ * usage: gmp_ops [operations]
+ */
+#include <lauxlib.h>
+#include <lua.h>
+#include <lualib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "lib/lib_gmp.h"
+
+struct variant {
+    const char *name;
+    const char *setup;
+};
+
+static const struct variant variants[] = {
+    {"lua number", "new = function(n) return n end"},
+    {"gmp double", "Gmp.precise = false new = Gmp.new"},
+    {"gmp mpfr", "Gmp.precise = true new = Gmp.new"},
+};
+
+// every iteration does 4 operations
+static const char *loop =
+    "local n = ...\n"
+    "local a, b, c = new(0.5), new(0.25), new(0)\n"
+    "for i = 1, n // 4 do\n"
+    "    c = (c + a) * b - b / a\n"
+    "end\n"
+    "return c\n";
+
+static double get_time()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int run_variant(lua_State *L, const struct variant *variant, long n)
+{
+    if (luaL_dostring(L, variant->setup) != LUA_OK) {
+        fprintf(stderr, "%s\n", lua_tostring(L, -1));
+        return 1;
+    }
+
+    if (luaL_loadstring(L, loop) != LUA_OK) {
+        fprintf(stderr, "%s\n", lua_tostring(L, -1));
+        return 1;
+    }
+    lua_pushinteger(L, n);
+
+    lua_gc(L, LUA_GCCOLLECT);
+    lua_gc(L, LUA_GCSTOP);
+    int kbytes = lua_gc(L, LUA_GCCOUNT);
+    int bytes = lua_gc(L, LUA_GCCOUNTB);
+    double start = get_time();
+
+    if (lua_pcall(L, 1, 1, 0) != LUA_OK) {
+        fprintf(stderr, "%s\n", lua_tostring(L, -1));
+        return 1;
+    }
+
+    double duration = get_time() - start;
+    double allocated = (lua_gc(L, LUA_GCCOUNT) - kbytes) * 1024.0
+        + lua_gc(L, LUA_GCCOUNTB) - bytes;
+    lua_gc(L, LUA_GCRESTART);
+    lua_pop(L, 1);
+
+    printf("%-12s %10.1f ns/op %10.1f bytes/op\n",
+            variant->name, duration * 1e9 / n, allocated / n);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    long n = argc > 1 ? atol(argv[1]) : 200000;
+    if (n <= 0) {
+        fprintf(stderr, "usage: %s [operations]\n", argv[0]);
+        return 1;
+    }
+
+    lua_State *L = luaL_newstate();
+    luaL_openlibs(L);
+    lua_load_gmp(L);
+
+    int res = 0;
+    for (int i = 0; i < sizeof(variants) / sizeof(variants[0]); i++) {
+        res |= run_variant(L, &variants[i], n);
+    }
+
+    lua_close(L);
+    return res;
+}
@@ -0,0 +1,135 @@
+/*
+ * Compares the json and the msgpack encoding of a get_tree reply.
+ *
+ * The tree has the shape of the i3 tree that ipc-json.c describes: a root,
+ * an output and a workspace node with the given number of window nodes that
+ * have all fields of ipc_json_create_node. For each encoding the time per
+ * encoded tree and its size are printed, as well as the time to decode the
+ * msgpack encoding again like japokmsg does.
+ *
+ * usage: ipc_encoding [windows] [iterations]
+ */
+#include <json.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "msgpack.h"
+
+static double get_time()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static json_object *create_rect(int x, int y, int width, int height)
+{
+    json_object *rect = json_object_new_object();
+    json_object_object_add(rect, "x", json_object_new_int(x));
+    json_object_object_add(rect, "y", json_object_new_int(y));
+    json_object_object_add(rect, "width", json_object_new_int(width));
+    json_object_object_add(rect, "height", json_object_new_int(height));
+    return rect;
+}
+
+static json_object *create_node(int id, const char *name, const char *type,
+        json_object *rect)
+{
+    json_object *object = json_object_new_object();
+    json_object_object_add(object, "id", json_object_new_int(id));
+    json_object_object_add(object, "name", json_object_new_string(name));
+    json_object_object_add(object, "type", json_object_new_string(type));
+    json_object_object_add(object, "rect", rect);
+    json_object_object_add(object, "focused", json_object_new_boolean(false));
+    json_object_object_add(object, "focus", NULL);
+    json_object_object_add(object, "border", json_object_new_string("none"));
+    json_object_object_add(object, "current_border_width", json_object_new_int(0));
+    json_object_object_add(object, "layout", NULL);
+    json_object_object_add(object, "orientation", NULL);
+    json_object_object_add(object, "percent", NULL);
+    json_object_object_add(object, "window_rect", create_rect(0, 0, 0, 0));
+    json_object_object_add(object, "deco_rect", create_rect(0, 0, 0, 0));
+    json_object_object_add(object, "geometry", create_rect(0, 0, 0, 0));
+    json_object_object_add(object, "window", NULL);
+    json_object_object_add(object, "urgent", json_object_new_boolean(false));
+    json_object_object_add(object, "marks", json_object_new_array());
+    json_object_object_add(object, "fullscreen_mode", json_object_new_int(0));
+    json_object_object_add(object, "nodes", json_object_new_array());
+    json_object_object_add(object, "floating_nodes", json_object_new_array());
+    json_object_object_add(object, "sticky", json_object_new_boolean(false));
+    return object;
+}
+
+static void add_child(json_object *parent, json_object *child)
+{
+    json_object *nodes;
+    json_object_object_get_ex(parent, "nodes", &nodes);
+    json_object_array_add(nodes, child);
+}
+
+static json_object *create_tree(int windows)
+{
+    json_object *root = create_node(1, "root", "root", create_rect(0, 0, 1920, 1080));
+    json_object *output = create_node(2, "HEADLESS-1", "output",
+            create_rect(0, 0, 1920, 1080));
+    json_object *tag = create_node(3, "1:1", "workspace",
+            create_rect(0, 0, 1920, 1080));
+    add_child(root, output);
+    add_child(output, tag);
+
+    for (int i = 0; i < windows; i++) {
+        char title[64];
+        snprintf(title, sizeof(title), "window %d - terminal", i);
+        json_object *con = create_node(10 + i, title, "con",
+                create_rect(i % 16 * 120, i / 16 * 80, 120, 80));
+        json_object_object_add(con, "app_id", json_object_new_string("foot"));
+        add_child(tag, con);
+    }
+    return root;
+}
+
+int main(int argc, char **argv)
+{
+    int windows = argc > 1 ? atoi(argv[1]) : 200;
+    long n = argc > 2 ? atol(argv[2]) : 2000;
+    if (windows < 0 || n <= 0) {
+        fprintf(stderr, "usage: %s [windows] [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    json_object *tree = create_tree(windows);
+
+    size_t json_len = 0;
+    double start = get_time();
+    for (long i = 0; i < n; i++) {
+        json_object_to_json_string_length(tree, JSON_C_TO_STRING_SPACED, &json_len);
+    }
+    double json_time = get_time() - start;
+
+    GByteArray *encoded = g_byte_array_new();
+    start = get_time();
+    for (long i = 0; i < n; i++) {
+        g_byte_array_set_size(encoded, 0);
+        msgpack_encode(encoded, tree);
+    }
+    double msgpack_time = get_time() - start;
+
+    start = get_time();
+    for (long i = 0; i < n; i++) {
+        json_object_put(msgpack_decode(encoded->data, encoded->len, NULL));
+    }
+    double decode_time = get_time() - start;
+
+    printf("get_tree with %d windows\n", windows);
+    printf("%-16s %10.1f us/tree %10zu bytes\n",
+            "json encode", json_time * 1e6 / n, json_len);
+    printf("%-16s %10.1f us/tree %10u bytes\n",
+            "msgpack encode", msgpack_time * 1e6 / n, encoded->len);
+    printf("%-16s %10.1f us/tree\n",
+            "msgpack decode", decode_time * 1e6 / n);
+
+    g_byte_array_unref(encoded);
+    json_object_put(tree);
+    return 0;
+}
@@ -0,0 +1,589 @@
+/*
+ * Load generator for the i3 compatible ipc socket of japokwm.
+ *
+ * It opens many connections to $JAPOKWMSOCK, sends pipelined
+ * IPC_GET_TAGS, IPC_GET_TREE and IPC_COMMAND messages and reports the
+ * throughput and the latency distribution of each message type. Optionally
+ * some connections subscribe to events and some connections read their
+ * replies very slowly to exercise the write buffer of the server.
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <getopt.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+static const char ipc_magic[] = {'i', '3', '-', 'i', 'p', 'c'};
+
+#define IPC_HEADER_SIZE (sizeof(ipc_magic) + 8)
+#define IPC_EVENT_BIT (1u << 31)
+#define MAX_PIPELINE 256
+
+enum ipc_message_type {
+    IPC_COMMAND = 0,
+    IPC_GET_TAGS = 1,
+    IPC_SUBSCRIBE = 2,
+    IPC_GET_TREE = 4,
+};
+
+enum request_kind {
+    REQUEST_GET_TAGS,
+    REQUEST_GET_TREE,
+    REQUEST_COMMAND,
+    REQUEST_KIND_COUNT,
+};
+
+static const char *request_names[] = {
+    [REQUEST_GET_TAGS] = "get_tags",
+    [REQUEST_GET_TREE] = "get_tree",
+    [REQUEST_COMMAND] = "command",
+};
+
+static const uint32_t request_types[] = {
+    [REQUEST_GET_TAGS] = IPC_GET_TAGS,
+    [REQUEST_GET_TREE] = IPC_GET_TREE,
+    [REQUEST_COMMAND] = IPC_COMMAND,
+};
+
+enum connection_role {
+    ROLE_WORKER,
+    ROLE_SUBSCRIBER,
+    ROLE_SLOW_READER,
+};
+
+struct buffer {
+    char *data;
+    size_t len;
+    size_t size;
+};
+
+struct connection {
+    int fd;
+    enum connection_role role;
+    bool is_closed;
+
+    // requests that were sent but not answered yet, replies arrive in order
+    uint64_t sent_at[MAX_PIPELINE];
+    enum request_kind sent_kind[MAX_PIPELINE];
+    size_t inflight_head;
+    size_t inflight_len;
+
+    size_t requests_sent;
+    size_t replies_received;
+    size_t events_received;
+    size_t bytes_received;
+    uint64_t next_read_at;
+
+    struct buffer in;
+    struct buffer out;
+};
+
+struct samples {
+    double *values;
+    size_t len;
+    size_t size;
+};
+
+struct options {
+    const char *socket_path;
+    int workers;
+    int subscribers;
+    int slow_readers;
+    int requests;
+    int pipeline;
+    // bytes a slow reader reads every slow_interval_ms
+    int slow_read_size;
+    int slow_interval_ms;
+    const char *command;
+    bool kinds[REQUEST_KIND_COUNT];
+};
+
+static struct samples latencies[REQUEST_KIND_COUNT];
+
+static uint64_t now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void buffer_reserve(struct buffer *buffer, size_t len)
+{
+    if (buffer->len + len <= buffer->size)
+        return;
+    size_t size = buffer->size ? buffer->size : 4096;
+    while (size < buffer->len + len)
+        size *= 2;
+    buffer->data = realloc(buffer->data, size);
+    if (!buffer->data) {
+        fprintf(stderr, "out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    buffer->size = size;
+}
+
+static void buffer_consume(struct buffer *buffer, size_t len)
+{
+    memmove(buffer->data, buffer->data + len, buffer->len - len);
+    buffer->len -= len;
+}
+
+static void samples_add(struct samples *samples, double value)
+{
+    if (samples->len == samples->size) {
+        samples->size = samples->size ? samples->size * 2 : 1024;
+        samples->values = realloc(samples->values,
+                samples->size * sizeof(*samples->values));
+        if (!samples->values) {
+            fprintf(stderr, "out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    samples->values[samples->len++] = value;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(struct samples *samples, double p)
+{
+    if (samples->len == 0)
+        return 0;
+    size_t i = (size_t)(p * (samples->len - 1) + 0.5);
+    return samples->values[i];
+}
+
+static int connect_socket(const char *socket_path)
+{
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        perror("socket");
+        return -1;
+    }
+
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1
+            && errno != EINPROGRESS) {
+        perror("connect");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void queue_message(struct connection *con, uint32_t type,
+        const char *payload)
+{
+    uint32_t len = strlen(payload);
+    buffer_reserve(&con->out, IPC_HEADER_SIZE + len);
+    char *data = con->out.data + con->out.len;
+    memcpy(data, ipc_magic, sizeof(ipc_magic));
+    memcpy(data + sizeof(ipc_magic), &len, sizeof(len));
+    memcpy(data + sizeof(ipc_magic) + sizeof(len), &type, sizeof(type));
+    memcpy(data + IPC_HEADER_SIZE, payload, len);
+    con->out.len += IPC_HEADER_SIZE + len;
+}
+
+static enum request_kind next_request_kind(struct options *options,
+        struct connection *con)
+{
+    size_t i = con->requests_sent;
+    for (;;) {
+        enum request_kind kind = i % REQUEST_KIND_COUNT;
+        if (options->kinds[kind])
+            return kind;
+        i++;
+    }
+}
+
+static void queue_requests(struct options *options, struct connection *con)
+{
+    if (con->role == ROLE_SUBSCRIBER)
+        return;
+
+    while (con->inflight_len < (size_t)options->pipeline
+            && (con->role == ROLE_SLOW_READER
+                || con->requests_sent < (size_t)options->requests)) {
+        enum request_kind kind = next_request_kind(options, con);
+        const char *payload = kind == REQUEST_COMMAND ? options->command : "";
+        queue_message(con, request_types[kind], payload);
+
+        size_t slot = (con->inflight_head + con->inflight_len) % MAX_PIPELINE;
+        con->sent_at[slot] = now_ns();
+        con->sent_kind[slot] = kind;
+        con->inflight_len++;
+        con->requests_sent++;
+    }
+}
+
+static void close_connection(struct connection *con)
+{
+    if (con->is_closed)
+        return;
+    close(con->fd);
+    con->is_closed = true;
+}
+
+static void handle_message(struct connection *con, uint32_t type)
+{
+    if (type & IPC_EVENT_BIT) {
+        con->events_received++;
+        return;
+    }
+    if (type == IPC_SUBSCRIBE && con->role != ROLE_WORKER)
+        return;
+    if (con->inflight_len == 0) {
+        fprintf(stderr, "unexpected reply of type %u\n", type);
+        return;
+    }
+
+    size_t slot = con->inflight_head;
+    double latency_us = (now_ns() - con->sent_at[slot]) / 1000.0;
+    samples_add(&latencies[con->sent_kind[slot]], latency_us);
+    con->inflight_head = (con->inflight_head + 1) % MAX_PIPELINE;
+    con->inflight_len--;
+    con->replies_received++;
+}
+
+static void parse_messages(struct connection *con)
+{
+    while (con->in.len >= IPC_HEADER_SIZE) {
+        if (memcmp(con->in.data, ipc_magic, sizeof(ipc_magic)) != 0) {
+            fprintf(stderr, "invalid ipc header\n");
+            close_connection(con);
+            return;
+        }
+        uint32_t len;
+        uint32_t type;
+        memcpy(&len, con->in.data + sizeof(ipc_magic), sizeof(len));
+        memcpy(&type, con->in.data + sizeof(ipc_magic) + sizeof(len),
+                sizeof(type));
+        if (con->in.len < IPC_HEADER_SIZE + len)
+            return;
+
+        handle_message(con, type);
+        buffer_consume(&con->in, IPC_HEADER_SIZE + len);
+    }
+}
+
+static void read_connection(struct options *options, struct connection *con)
+{
+    size_t max_read = 65536;
+    if (con->role == ROLE_SLOW_READER) {
+        uint64_t now = now_ns();
+        if (now < con->next_read_at)
+            return;
+        con->next_read_at = now + options->slow_interval_ms * 1000000ull;
+        max_read = options->slow_read_size;
+    }
+
+    buffer_reserve(&con->in, max_read);
+    ssize_t n = read(con->fd, con->in.data + con->in.len, max_read);
+    if (n == 0 || (n == -1 && errno != EAGAIN && errno != EINTR)) {
+        close_connection(con);
+        return;
+    }
+    if (n < 0)
+        return;
+
+    con->in.len += n;
+    con->bytes_received += n;
+    parse_messages(con);
+}
+
+static void write_connection(struct connection *con)
+{
+    if (con->out.len == 0)
+        return;
+    ssize_t n = write(con->fd, con->out.data, con->out.len);
+    if (n == -1) {
+        if (errno != EAGAIN && errno != EINTR)
+            close_connection(con);
+        return;
+    }
+    buffer_consume(&con->out, n);
+}
+
+static bool is_worker_done(struct options *options, struct connection *con)
+{
+    return con->is_closed
+        || (con->replies_received >= (size_t)options->requests
+            && con->inflight_len == 0);
+}
+
+static void print_usage()
+{
+    printf("Usage: ipc_load [options]\n\n"
+            "  -s, --socket <path>      socket to connect to (default $JAPOKWMSOCK)\n"
+            "  -c, --connections <n>    number of connections sending requests (default 16)\n"
+            "  -n, --requests <n>       requests per connection (default 1000)\n"
+            "  -d, --pipeline <n>       requests in flight per connection (default 8)\n"
+            "  -t, --types <list>       comma separated list of get_tags, get_tree\n"
+            "                           and command (default all)\n"
+            "  -C, --command <cmd>      payload of IPC_COMMAND (default \"return 0\")\n"
+            "  -e, --subscribers <n>    connections that only subscribe to events\n"
+            "  -S, --slow-readers <n>   connections that subscribe, send requests\n"
+            "                           and read their replies slowly\n"
+            "  -r, --slow-read <bytes>  bytes a slow reader reads per interval (default 64)\n"
+            "  -i, --slow-interval <ms> read interval of slow readers (default 100)\n"
+            "  -h, --help               show this message\n");
+}
+
+static bool parse_types(struct options *options, const char *arg)
+{
+    for (int i = 0; i < REQUEST_KIND_COUNT; i++) {
+        options->kinds[i] = false;
+    }
+
+    char *types = strdup(arg);
+    bool any = false;
+    for (char *tok = strtok(types, ","); tok; tok = strtok(NULL, ",")) {
+        bool found = false;
+        for (int i = 0; i < REQUEST_KIND_COUNT; i++) {
+            if (strcmp(tok, request_names[i]) == 0) {
+                options->kinds[i] = true;
+                found = true;
+            }
+        }
+        if (!found) {
+            fprintf(stderr, "unknown type: %s\n", tok);
+            free(types);
+            return false;
+        }
+        any = true;
+    }
+    free(types);
+    return any;
+}
+
+static void print_results(struct options *options, struct connection *cons,
+        int con_count, double elapsed_s)
+{
+    size_t total = 0;
+    for (int i = 0; i < REQUEST_KIND_COUNT; i++) {
+        total += latencies[i].len;
+    }
+
+    printf("%zu replies in %.3f s: %.0f replies/s\n",
+            total, elapsed_s, total / elapsed_s);
+    printf("%-10s %8s %10s %10s %10s %10s %10s (us)\n",
+            "type", "count", "p50", "p90", "p99", "p99.9", "max");
+    for (int i = 0; i < REQUEST_KIND_COUNT; i++) {
+        struct samples *samples = &latencies[i];
+        if (samples->len == 0)
+            continue;
+        qsort(samples->values, samples->len, sizeof(*samples->values),
+                cmp_double);
+        printf("%-10s %8zu %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+                request_names[i], samples->len,
+                percentile(samples, 0.5),
+                percentile(samples, 0.9),
+                percentile(samples, 0.99),
+                percentile(samples, 0.999),
+                samples->values[samples->len - 1]);
+    }
+
+    size_t events = 0;
+    size_t worker_failures = 0;
+    for (int i = 0; i < con_count; i++) {
+        struct connection *con = &cons[i];
+        if (con->role == ROLE_SUBSCRIBER)
+            events += con->events_received;
+        if (con->role == ROLE_WORKER
+                && con->replies_received < (size_t)options->requests)
+            worker_failures++;
+    }
+    if (options->subscribers > 0) {
+        printf("subscribers received %zu events\n", events);
+    }
+    if (worker_failures > 0) {
+        printf("%zu connections were closed before all replies arrived\n",
+                worker_failures);
+    }
+    for (int i = 0; i < con_count; i++) {
+        struct connection *con = &cons[i];
+        if (con->role != ROLE_SLOW_READER)
+            continue;
+        printf("slow reader %d: %zu requests sent, %zu bytes read, %s\n",
+                i, con->requests_sent, con->bytes_received,
+                con->is_closed ? "disconnected by the server" : "still connected");
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    struct options options = {
+        .socket_path = getenv("JAPOKWMSOCK"),
+        .workers = 16,
+        .requests = 1000,
+        .pipeline = 8,
+        .slow_read_size = 64,
+        .slow_interval_ms = 100,
+        .command = "return 0",
+        .kinds = {true, true, true},
+    };
+
+    static struct option long_options[] = {
+        {"socket", required_argument, NULL, 's'},
+        {"connections", required_argument, NULL, 'c'},
+        {"requests", required_argument, NULL, 'n'},
+        {"pipeline", required_argument, NULL, 'd'},
+        {"types", required_argument, NULL, 't'},
+        {"command", required_argument, NULL, 'C'},
+        {"subscribers", required_argument, NULL, 'e'},
+        {"slow-readers", required_argument, NULL, 'S'},
+        {"slow-read", required_argument, NULL, 'r'},
+        {"slow-interval", required_argument, NULL, 'i'},
+        {"help", no_argument, NULL, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "s:c:n:d:t:C:e:S:r:i:h",
+                    long_options, NULL)) != -1) {
+        switch (c) {
+            case 's':
+                options.socket_path = optarg;
+                break;
+            case 'c':
+                options.workers = atoi(optarg);
+                break;
+            case 'n':
+                options.requests = atoi(optarg);
+                break;
+            case 'd':
+                options.pipeline = atoi(optarg);
+                break;
+            case 't':
+                if (!parse_types(&options, optarg))
+                    return EXIT_FAILURE;
+                break;
+            case 'C':
+                options.command = optarg;
+                break;
+            case 'e':
+                options.subscribers = atoi(optarg);
+                break;
+            case 'S':
+                options.slow_readers = atoi(optarg);
+                break;
+            case 'r':
+                options.slow_read_size = atoi(optarg);
+                break;
+            case 'i':
+                options.slow_interval_ms = atoi(optarg);
+                break;
+            case 'h':
+                print_usage();
+                return EXIT_SUCCESS;
+            default:
+                print_usage();
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (!options.socket_path) {
+        fprintf(stderr, "JAPOKWMSOCK is not set, use --socket\n");
+        return EXIT_FAILURE;
+    }
+    if (options.pipeline < 1 || options.pipeline > MAX_PIPELINE) {
+        fprintf(stderr, "the pipeline depth has to be in [1, %d]\n",
+                MAX_PIPELINE);
+        return EXIT_FAILURE;
+    }
+    if (options.slow_read_size < 1)
+        options.slow_read_size = 1;
+
+    int con_count = options.workers + options.subscribers + options.slow_readers;
+    struct connection *cons = calloc(con_count, sizeof(*cons));
+    struct pollfd *pfds = calloc(con_count, sizeof(*pfds));
+
+    for (int i = 0; i < con_count; i++) {
+        struct connection *con = &cons[i];
+        if (i < options.workers) {
+            con->role = ROLE_WORKER;
+        } else if (i < options.workers + options.subscribers) {
+            con->role = ROLE_SUBSCRIBER;
+        } else {
+            con->role = ROLE_SLOW_READER;
+        }
+
+        con->fd = connect_socket(options.socket_path);
+        if (con->fd == -1)
+            return EXIT_FAILURE;
+
+        if (con->role != ROLE_WORKER) {
+            queue_message(con, IPC_SUBSCRIBE, "[\"workspace\", \"window\"]");
+        }
+    }
+
+    uint64_t start = now_ns();
+    for (;;) {
+        bool workers_done = true;
+        for (int i = 0; i < con_count; i++) {
+            struct connection *con = &cons[i];
+            if (con->role == ROLE_WORKER && !is_worker_done(&options, con))
+                workers_done = false;
+        }
+        if (workers_done)
+            break;
+
+        for (int i = 0; i < con_count; i++) {
+            struct connection *con = &cons[i];
+            pfds[i].fd = con->is_closed ? -1 : con->fd;
+            pfds[i].events = 0;
+            if (con->is_closed)
+                continue;
+
+            queue_requests(&options, con);
+            if (con->out.len > 0)
+                pfds[i].events |= POLLOUT;
+            if (con->role != ROLE_SLOW_READER || now_ns() >= con->next_read_at)
+                pfds[i].events |= POLLIN;
+        }
+
+        int timeout = options.slow_readers > 0 ? options.slow_interval_ms : -1;
+        if (poll(pfds, con_count, timeout) == -1 && errno != EINTR) {
+            perror("poll");
+            return EXIT_FAILURE;
+        }
+
+        for (int i = 0; i < con_count; i++) {
+            struct connection *con = &cons[i];
+            if (con->is_closed)
+                continue;
+            if (pfds[i].revents & POLLOUT)
+                write_connection(con);
+            if (pfds[i].revents & (POLLIN | POLLHUP | POLLERR))
+                read_connection(&options, con);
+        }
+    }
+    double elapsed_s = (now_ns() - start) / 1e9;
+
+    print_results(&options, cons, con_count, elapsed_s);
+
+    for (int i = 0; i < con_count; i++) {
+        close_connection(&cons[i]);
+        free(cons[i].in.data);
+        free(cons[i].out.data);
+    }
+    for (int i = 0; i < REQUEST_KIND_COUNT; i++) {
+        free(latencies[i].values);
+    }
+    free(cons);
+    free(pfds);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,46 @@
+#!/bin/sh
+# Compares the latency per command of one japokmsg process per command with
+# a single `japokmsg --batch` that pipelines all commands over one
+# connection. Run it against a running japokwm ($JAPOKWMSOCK must be set).
+#
+# usage: japokmsg_batch.sh <japokmsg> [commands]
+
+japokmsg="$1"
+commands="${2:-100}"
+
+if [ -z "$japokmsg" ]; then
+    echo "usage: $0 <japokmsg> [commands]" >&2
+    exit 1
+fi
+if [ -z "$JAPOKWMSOCK" ]; then
+    echo "JAPOKWMSOCK is not set, start japokwm first" >&2
+    exit 1
+fi
+
+command="local x = 1"
+
+now_ns() {
+    date +%s%N
+}
+
+start="$(now_ns)"
+i=0
+while [ "$i" -lt "$commands" ]; do
+    "$japokmsg" -q "$command" > /dev/null || exit 1
+    i=$((i + 1))
+done
+single=$(($(now_ns) - start))
+
+start="$(now_ns)"
+i=0
+while [ "$i" -lt "$commands" ]; do
+    echo "$command"
+    i=$((i + 1))
+done | "$japokmsg" --batch -q || exit 1
+batch=$(($(now_ns) - start))
+
+awk -v n="$commands" -v single="$single" -v batch="$batch" 'BEGIN {
+    printf "%d commands\n", n
+    printf "  one process per command %9.3f ms/command\n", single / n / 1e6
+    printf "  --batch                 %9.3f ms/command\n", batch / n / 1e6
+}'
@@ -0,0 +1,74 @@
+#!/bin/sh
+# Measures the time to the first frame of japokwm with the headless backend
+# and prints the average duration of each startup phase.
+#
+# usage: startup.sh <japokwm> [runs]
+
+japokwm="$1"
+runs="${2:-10}"
+
+if [ -z "$japokwm" ]; then
+    echo "usage: $0 <japokwm> [runs]" >&2
+    exit 1
+fi
+
+export WLR_BACKENDS=headless
+export WLR_HEADLESS_OUTPUTS=1
+export WLR_LIBINPUT_NO_DEVICES=1
+export WLR_RENDERER="${WLR_RENDERER:-pixman}"
+if [ -z "$XDG_RUNTIME_DIR" ]; then
+    XDG_RUNTIME_DIR="$(mktemp -d)"
+    export XDG_RUNTIME_DIR
+fi
+
+results="$(mktemp)"
+trap 'rm -f "$results"' EXIT
+
+i=0
+while [ "$i" -lt "$runs" ]; do
+    out="$(mktemp)"
+    "$japokwm" --startup-profile > "$out" 2>&1 &
+    pid=$!
+
+    # wait at most 30 seconds for the first frame
+    tries=0
+    while ! grep -q "^startup: time to first frame" "$out"; do
+        if [ "$tries" -ge 300 ] || ! kill -0 "$pid" 2> /dev/null; then
+            echo "japokwm didn't render a frame, output:" >&2
+            cat "$out" >&2
+            kill "$pid" 2> /dev/null
+            rm -f "$out"
+            exit 1
+        fi
+        tries=$((tries + 1))
+        sleep 0.1
+    done
+
+    kill "$pid" 2> /dev/null
+    wait "$pid" 2> /dev/null
+    cat "$out" >> "$results"
+    rm -f "$out"
+    i=$((i + 1))
+done
+
+# phase lines look like "  <name> <duration> ms (at <offset> ms)"
+awk -v runs="$runs" '
+    /^startup: time to first frame/ {
+        ttff += $(NF-1)
+        if (min == "" || $(NF-1) < min) min = $(NF-1)
+        if ($(NF-1) > max) max = $(NF-1)
+    }
+    /^  .* ms \(at/ {
+        name = $0
+        sub(/^  /, "", name)
+        sub(/ +[0-9.]+ ms \(at.*$/, "", name)
+        if (!(name in sum)) order[n++] = name
+        sum[name] += $(NF-4)
+    }
+    END {
+        printf "average over %d runs:\n", runs
+        for (i = 0; i < n; i++)
+            printf "  %-24s %9.3f ms\n", order[i], sum[order[i]] / runs
+        printf "time to first frame: avg %.3f ms, min %.3f ms, max %.3f ms\n",
+            ttff / runs, min, max
+    }' "$results"
@@ -0,0 +1,284 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "msgpack.h"
+
+// nested arrays and maps deeper than this are rejected by the decoder
+#define MAX_DEPTH 128
+
+static void write_be(GByteArray *out, uint8_t type, uint64_t value, int size) {
+    uint8_t buf[9];
+    buf[0] = type;
+    for (int i = 0; i < size; i++) {
+        buf[size - i] = (value >> (8 * i)) & 0xff;
+    }
+    g_byte_array_append(out, buf, size + 1);
+}
+
+static void write_byte(GByteArray *out, uint8_t byte) {
+    g_byte_array_append(out, &byte, 1);
+}
+
+static void encode_int(GByteArray *out, int64_t n) {
+    if (n >= 0) {
+        if (n <= 0x7f) {
+            write_byte(out, n);
+        } else if (n <= UINT8_MAX) {
+            write_be(out, 0xcc, n, 1);
+        } else if (n <= UINT16_MAX) {
+            write_be(out, 0xcd, n, 2);
+        } else if (n <= UINT32_MAX) {
+            write_be(out, 0xce, n, 4);
+        } else {
+            write_be(out, 0xcf, n, 8);
+        }
+        return;
+    }
+
+    if (n >= -32) {
+        write_byte(out, (uint8_t)(int8_t)n);
+    } else if (n >= INT8_MIN) {
+        write_be(out, 0xd0, (uint8_t)(int8_t)n, 1);
+    } else if (n >= INT16_MIN) {
+        write_be(out, 0xd1, (uint16_t)(int16_t)n, 2);
+    } else if (n >= INT32_MIN) {
+        write_be(out, 0xd2, (uint32_t)(int32_t)n, 4);
+    } else {
+        write_be(out, 0xd3, (uint64_t)n, 8);
+    }
+}
+
+static void encode_double(GByteArray *out, double d) {
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    write_be(out, 0xcb, bits, 8);
+}
+
+static void encode_string(GByteArray *out, const char *str, size_t len) {
+    if (len < 32) {
+        write_byte(out, 0xa0 | len);
+    } else if (len <= UINT8_MAX) {
+        write_be(out, 0xd9, len, 1);
+    } else if (len <= UINT16_MAX) {
+        write_be(out, 0xda, len, 2);
+    } else {
+        write_be(out, 0xdb, len, 4);
+    }
+    g_byte_array_append(out, (const uint8_t *)str, len);
+}
+
+// the header of an array (fix_type 0x90) or a map (fix_type 0x80)
+static void encode_container(GByteArray *out, uint8_t fix_type,
+        uint8_t type16, size_t len) {
+    if (len < 16) {
+        write_byte(out, fix_type | len);
+    } else if (len <= UINT16_MAX) {
+        write_be(out, type16, len, 2);
+    } else {
+        write_be(out, type16 + 1, len, 4);
+    }
+}
+
+void msgpack_encode(GByteArray *out, json_object *object) {
+    switch (json_object_get_type(object)) {
+        case json_type_null:
+            write_byte(out, 0xc0);
+            break;
+        case json_type_boolean:
+            write_byte(out, json_object_get_boolean(object) ? 0xc3 : 0xc2);
+            break;
+        case json_type_int:
+            encode_int(out, json_object_get_int64(object));
+            break;
+        case json_type_double:
+            encode_double(out, json_object_get_double(object));
+            break;
+        case json_type_string:
+            encode_string(out, json_object_get_string(object),
+                    json_object_get_string_len(object));
+            break;
+        case json_type_array:
+            {
+                size_t len = json_object_array_length(object);
+                encode_container(out, 0x90, 0xdc, len);
+                for (size_t i = 0; i < len; i++) {
+                    msgpack_encode(out, json_object_array_get_idx(object, i));
+                }
+            }
+            break;
+        case json_type_object:
+            encode_container(out, 0x80, 0xde, json_object_object_length(object));
+            json_object_object_foreach(object, key, value) {
+                encode_string(out, key, strlen(key));
+                msgpack_encode(out, value);
+            }
+            break;
+    }
+}
+
+struct reader {
+    const uint8_t *data;
+    size_t len;
+    size_t pos;
+    bool error;
+};
+
+static uint64_t read_be(struct reader *reader, int size) {
+    if (reader->len - reader->pos < (size_t)size) {
+        reader->error = true;
+        return 0;
+    }
+
+    uint64_t value = 0;
+    for (int i = 0; i < size; i++) {
+        value = (value << 8) | reader->data[reader->pos++];
+    }
+    return value;
+}
+
+static const char *read_bytes(struct reader *reader, uint64_t len) {
+    if (reader->len - reader->pos < len) {
+        reader->error = true;
+        return NULL;
+    }
+
+    const char *bytes = (const char *)reader->data + reader->pos;
+    reader->pos += len;
+    return bytes;
+}
+
+static json_object *decode_value(struct reader *reader, int depth);
+
+static json_object *decode_array(struct reader *reader, uint64_t len, int depth) {
+    json_object *array = json_object_new_array();
+    for (uint64_t i = 0; i < len && !reader->error; i++) {
+        json_object_array_add(array, decode_value(reader, depth + 1));
+    }
+    return array;
+}
+
+static json_object *decode_map(struct reader *reader, uint64_t len, int depth) {
+    json_object *map = json_object_new_object();
+    for (uint64_t i = 0; i < len && !reader->error; i++) {
+        json_object *key = decode_value(reader, depth + 1);
+        if (!json_object_is_type(key, json_type_string)) {
+            json_object_put(key);
+            reader->error = true;
+            break;
+        }
+        json_object *value = decode_value(reader, depth + 1);
+        json_object_object_add(map, json_object_get_string(key), value);
+        json_object_put(key);
+    }
+    return map;
+}
+
+static json_object *decode_string(struct reader *reader, uint64_t len) {
+    const char *str = read_bytes(reader, len);
+    if (!str) {
+        return NULL;
+    }
+    return json_object_new_string_len(str, len);
+}
+
+static json_object *decode_value(struct reader *reader, int depth) {
+    if (depth > MAX_DEPTH || reader->pos >= reader->len) {
+        reader->error = true;
+        return NULL;
+    }
+
+    uint8_t type = reader->data[reader->pos++];
+    if (type <= 0x7f) {
+        return json_object_new_int64(type);
+    }
+    if (type >= 0xe0) {
+        return json_object_new_int64((int8_t)type);
+    }
+    if ((type & 0xe0) == 0xa0) {
+        return decode_string(reader, type & 0x1f);
+    }
+    if ((type & 0xf0) == 0x90) {
+        return decode_array(reader, type & 0x0f, depth);
+    }
+    if ((type & 0xf0) == 0x80) {
+        return decode_map(reader, type & 0x0f, depth);
+    }
+
+    switch (type) {
+        case 0xc0:
+            return NULL;
+        case 0xc2:
+            return json_object_new_boolean(false);
+        case 0xc3:
+            return json_object_new_boolean(true);
+        case 0xca:
+            {
+                uint32_t bits = read_be(reader, 4);
+                float f;
+                memcpy(&f, &bits, sizeof(f));
+                return json_object_new_double(f);
+            }
+        case 0xcb:
+            {
+                uint64_t bits = read_be(reader, 8);
+                double d;
+                memcpy(&d, &bits, sizeof(d));
+                return json_object_new_double(d);
+            }
+        case 0xcc:
+            return json_object_new_int64(read_be(reader, 1));
+        case 0xcd:
+            return json_object_new_int64(read_be(reader, 2));
+        case 0xce:
+            return json_object_new_int64(read_be(reader, 4));
+        case 0xcf:
+            return json_object_new_int64((int64_t)read_be(reader, 8));
+        case 0xd0:
+            return json_object_new_int64((int8_t)read_be(reader, 1));
+        case 0xd1:
+            return json_object_new_int64((int16_t)read_be(reader, 2));
+        case 0xd2:
+            return json_object_new_int64((int32_t)read_be(reader, 4));
+        case 0xd3:
+            return json_object_new_int64((int64_t)read_be(reader, 8));
+        case 0xd9:
+            return decode_string(reader, read_be(reader, 1));
+        case 0xda:
+            return decode_string(reader, read_be(reader, 2));
+        case 0xdb:
+            return decode_string(reader, read_be(reader, 4));
+        case 0xdc:
+            return decode_array(reader, read_be(reader, 2), depth);
+        case 0xdd:
+            return decode_array(reader, read_be(reader, 4), depth);
+        case 0xde:
+            return decode_map(reader, read_be(reader, 2), depth);
+        case 0xdf:
+            return decode_map(reader, read_be(reader, 4), depth);
+        default:
+            // binary data, extensions and reserved types have no json value
+            reader->error = true;
+            return NULL;
+    }
+}
+
+json_object *msgpack_decode(const uint8_t *data, size_t len, bool *error) {
+    struct reader reader = {
+        .data = data,
+        .len = len,
+    };
+    json_object *object = decode_value(&reader, 0);
+    if (reader.pos != reader.len) {
+        reader.error = true;
+    }
+    if (reader.error) {
+        json_object_put(object);
+        object = NULL;
+    }
+    if (error) {
+        *error = reader.error;
+    }
+    return object;
+}
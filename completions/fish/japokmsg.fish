@@ -2,3 +2,5 @@
 
 complete -f -c japokmsg
 complete -c japokmsg -s v -l version --description "Print the version (of japokmsg) and quit."
+complete -c japokmsg -s b -l batch --description "Send every line of stdin as a message over one connection."
+complete -c japokmsg -s e -l encoding -x -a "json msgpack" --description "Receive replies as json or msgpack."
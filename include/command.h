@@ -55,7 +55,13 @@ struct cmd_results *execute_command(
         char *cmd,
         struct wlr_seat *seat,
         struct container *con);
+/**
+ * Evaluates all commands in a single transaction, so that they are arranged
+ * once. Returns an array with the results of the commands.
+ */
+struct cmd_results **execute_commands(char **cmds, size_t count);
 char *cmd_results_to_json(struct cmd_results *results);
+char *cmd_results_list_to_json(struct cmd_results **results, size_t count);
 
 struct cmd_results *cmd_eval(const char *cmd);
 
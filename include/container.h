@@ -33,6 +33,9 @@ struct container_property {
 };
 
 struct container {
+    // unique for the lifetime of the compositor, used to identify the
+    // container in ipc events
+    uint32_t id;
     GPtrArray *properties;
 
     // if this is set it will overwrite the other geometries
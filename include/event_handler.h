@@ -6,6 +6,9 @@
 #include <glib.h>
 
 struct container;
+struct monitor;
+struct tag;
+struct wl_event_source;
 
 struct event_handler {
     GPtrArray *on_start_func_refs;
@@ -13,6 +16,17 @@ struct event_handler {
     GPtrArray *on_focus_func_refs;
     GPtrArray *on_update_func_refs;
     GPtrArray *on_create_container_func_refs;
+
+    /* everything that changed since on_update was emitted the last time.
+     * on_update is emitted once for all changes from an idle handler */
+    GPtrArray *changed_tag_ids;
+    GPtrArray *changed_monitors;
+    GPtrArray *changed_containers;
+    struct wl_event_source *update_source;
+
+    // the state of tags and monitors when they were arranged the last time
+    GHashTable *tag_states;
+    GHashTable *monitor_states;
 };
 
 struct event_handler *create_event_handler();
@@ -28,6 +42,18 @@ void call_create_container_function(struct event_handler *ev, int n);
 void call_on_focus_function(struct event_handler *ev, struct container *con);
 void call_on_unfocus_function(struct event_handler *ev, struct container *con);
 void call_on_start_function(struct event_handler *ev);
-void call_update_function(struct event_handler *ev, int n);
+
+/* the following functions compare the tag/monitor to the state it had when it
+ * was arranged the last time and schedule on_update if it changed */
+void event_handler_update_tag(struct event_handler *ev, struct tag *tag);
+void event_handler_update_monitor(struct event_handler *ev, struct monitor *m);
+/* schedule on_update because the geometry or the visibility of the container
+ * changed */
+void event_handler_mark_container(struct event_handler *ev,
+        struct container *con);
+// forget pending changes of objects that are about to be destroyed
+void event_handler_remove_monitor(struct event_handler *ev, struct monitor *m);
+void event_handler_remove_container(struct event_handler *ev,
+        struct container *con);
 
 #endif /* EVENT_HANDLER_H */
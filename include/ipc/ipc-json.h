@@ -7,7 +7,10 @@
 
 json_object *ipc_json_describe_tagsets();
 json_object *ipc_json_describe_tag(const char *name, bool is_selected, struct monitor *m);
+json_object *ipc_json_describe_monitor(struct monitor *m);
+json_object *ipc_json_describe_container(struct container *con);
 json_object *ipc_json_describe_selected_container(struct monitor *m);
 json_object *ipc_json_describe_bar_config();
+json_object *ipc_json_describe_stats();
 
 #endif
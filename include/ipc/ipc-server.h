@@ -5,14 +5,38 @@
 
 #include "ipc/ipc.h"
 
+struct container;
+struct monitor;
+struct tag;
+
 void ipc_init(struct wl_event_loop *wl_event_loop);
 bool ipc_send_reply(struct ipc_client *client, enum ipc_command_type payload_type,
     const char *payload, uint32_t payload_length);
 
 struct sockaddr_un *ipc_user_sockaddr(void);
 
-void ipc_event_tag();
-void ipc_event_window();
+/* change is one of the i3 workspace event changes like "focus" or "rename",
+ * tag and old may be NULL */
+void ipc_event_tag(const char *change, struct tag *tag, struct tag *old);
+// change is one of the i3 window event changes like "new", "focus" or "close"
+void ipc_event_window(const char *change, struct container *con);
+void ipc_event_output(struct monitor *m);
+/* workspace and window events are collected until they are released. Each
+ * change of an object is sent once and describes the object at the time of
+ * the release */
+void ipc_events_hold();
+void ipc_events_release();
+// the number of collected events, 0 if events aren't held back
+size_t ipc_events_pending_count();
+/* the replies to get_tags and get_tree are cached until the state they
+ * describe changes. Tags and monitors are part of both replies, containers
+ * only of get_tree */
+void ipc_snapshot_invalidate_tags();
+void ipc_snapshot_invalidate_containers();
+/* returns the reply to a query for the part of the state that selector points
+ * to, e.g. focused/name or tag/1/window_count, so clients don't need
+ * get_tree for a single value */
+json_object *ipc_query(const char *selector);
 int handle_client_payload(struct ipc_client *client);
 
 #endif //SWAY_IPC_SERVER_H
@@ -1,6 +1,7 @@
 #ifndef IPC_H
 #define IPC_H
 
+#include <json.h>
 #include <sys/socket.h>
 
 #include "server.h"
@@ -18,8 +19,14 @@ enum ipc_command_type {
     IPC_GET_TREE = 4,
     IPC_GET_BAR_CONFIG = 6,
 
+    // japokwm specific message types
+    IPC_GET_STATS = 200,
+    IPC_SET_ENCODING = 201,
+    IPC_QUERY = 202,
+
     // Event Types
     IPC_EVENT_TAG = ((1<<31) | 0),
+    IPC_EVENT_OUTPUT = ((1<<31) | 1),
     IPC_EVENT_MODE = ((1<<31) | 2),
     IPC_EVENT_WINDOW = ((1<<31) | 3),
     IPC_EVENT_BARCONFIG_UPDATE = ((1<<31) | 4),
@@ -27,17 +34,98 @@ enum ipc_command_type {
     IPC_EVENT_SHUTDOWN = ((1<<31) | 6),
     IPC_EVENT_TICK = ((1<<31) | 7),
 };
-;
 
 
+// how the payloads of replies and events are encoded for a client
+enum ipc_encoding {
+    IPC_ENCODING_JSON,
+    IPC_ENCODING_MSGPACK,
+    IPC_ENCODING_COUNT,
+};
+
+/* a json object that is encoded at most once per encoding no matter to how
+ * many clients it is sent */
+struct ipc_payload {
+    // NULL is sent as an empty payload
+    json_object *object;
+    // flags for json_object_to_json_string_ext
+    int json_flags;
+    GByteArray *encoded[IPC_ENCODING_COUNT];
+};
+
+// what an event is about, this is matched against subscription filters
+struct ipc_event_info {
+    const char *change;
+    // the name of the output, NULL if unknown
+    const char *output;
+    // -1 if unknown
+    int64_t tag_id;
+    const char *app_id;
+    /* the tags or containers that the event describes, -1 if unused. Delta
+     * subscribers that skipped an event about one of them get the complete
+     * payload of the next event about it */
+    int64_t object_ids[2];
+};
+
+// a subscription to the events that match all of the set fields
+struct ipc_filter {
+    enum ipc_command_type event;
+    char *output;
+    // -1 matches every tag
+    int64_t tag_id;
+    char *app_id;
+    // a NULL terminated list of changes, NULL matches every change
+    char **changes;
+};
+
+// what happens when the queued messages of a client exceed the limit
+enum ipc_overflow_policy {
+    // drop the oldest queued events, disconnect if replies alone exceed it
+    IPC_OVERFLOW_DROP_OLDEST,
+    IPC_OVERFLOW_DISCONNECT,
+};
+
+/* a message that is waiting to be written to a client. The payload is
+ * shared by every client the same event was sent to and must not be changed
+ * after it was queued */
+struct ipc_message {
+    char header[IPC_HEADER_SIZE];
+    GByteArray *payload;
+    // header and payload
+    size_t len;
+    // bytes that were already written
+    size_t offset;
+    // replies are never dropped
+    bool is_event;
+    // a queued event with the same key is replaced by newer ones, may be NULL
+    char *coalesce_key;
+};
+
+struct ipc_client_stats {
+    size_t max_queued_bytes;
+    uint64_t coalesced_events;
+    uint64_t dropped_events;
+};
+
 struct ipc_client {
     struct wl_event_source *event_source;
     struct wl_event_source *writable_event_source;
     int fd;
     enum ipc_command_type subscribed_events;
-    size_t write_buffer_len;
-    size_t write_buffer_size;
-    char *write_buffer;
+    // events that are only sent if they match one of the filters
+    uint32_t filtered_events;
+    // struct ipc_filter
+    GPtrArray *filters;
+    /* the objects that delta subscribers didn't receive the last change of,
+     * the keys are int64_t built by the event type and the id */
+    GHashTable *stale_objects;
+    // whether events are sent as deltas instead of complete objects
+    bool delta_events;
+    enum ipc_encoding encoding;
+    // struct ipc_message
+    GQueue *write_queue;
+    size_t queued_bytes;
+    struct ipc_client_stats stats;
     // The following are for storing data between event_loop calls
     uint32_t pending_length;
     enum ipc_command_type pending_type;
@@ -45,10 +133,50 @@ struct ipc_client {
 
 
 int ipc_client_handle_readable(int client_fd, uint32_t mask, void *data);
+void ipc_client_disconnect(struct ipc_client *client);
 int ipc_client_handle_writable(int client_fd, uint32_t mask, void *data);
+/* sends a json payload, it is converted if the client uses another
+ * encoding */
 bool ipc_send_reply(struct ipc_client *client,
                     enum ipc_command_type payload_type, const char *payload,
                     uint32_t payload_length);
-void ipc_send_event(const char *json_string, enum ipc_command_type event);
+bool ipc_send_payload(struct ipc_client *client,
+        enum ipc_command_type payload_type, struct ipc_payload *payload);
+/* info may be NULL, then the event is only sent to clients that subscribed
+ * to it without a filter */
+void ipc_send_event(struct ipc_payload *payload, enum ipc_command_type event,
+        struct ipc_event_info *info);
+/* sends delta to the clients that subscribed to delta events and payload to
+ * all other subscribers */
+void ipc_send_event_payloads(struct ipc_payload *payload,
+        struct ipc_payload *delta, enum ipc_command_type event,
+        struct ipc_event_info *info, const char *coalesce_key);
+/* returns true if a client that receives complete payloads (delta_events is
+ * false) or deltas wants the event */
+bool ipc_has_subscribers(enum ipc_command_type event, bool delta_events,
+        struct ipc_event_info *info);
+// called when an object of event info's object_ids doesn't exist anymore
+void ipc_forget_object(enum ipc_command_type event, int64_t id);
+
+struct ipc_filter *create_ipc_filter(enum ipc_command_type event);
+void destroy_ipc_filter(void *filter);
+void ipc_client_add_filter(struct ipc_client *client, struct ipc_filter *filter);
+GPtrArray *ipc_get_clients();
+
+// takes the reference to object
+void ipc_payload_init(struct ipc_payload *payload, json_object *object,
+        int json_flags);
+void ipc_payload_finish(struct ipc_payload *payload);
+/* encodes the payload unless it was encoded before, the result is queued
+ * without copying it, so it must not be changed */
+GByteArray *ipc_payload_get(struct ipc_payload *payload,
+        enum ipc_encoding encoding);
+// returns -1 if name isn't "json" or "msgpack"
+int ipc_encoding_from_string(const char *name);
+
+void ipc_set_queue_limit(size_t limit);
+size_t ipc_get_queue_limit();
+void ipc_set_overflow_policy(enum ipc_overflow_policy policy);
+enum ipc_overflow_policy ipc_get_overflow_policy();
 
 #endif // IPC_H
@@ -17,15 +17,21 @@
 struct layout;
 struct options;
 
+/* keybindings are immutable once they were added to options and are shared
+ * between all options they were copied to */
 struct keybinding {
     char *binding;
     int lua_func_ref;
+    int ref_count;
 };
 
 struct keybinding *create_keybinding(const char *binding, int lua_func_ref);
+struct keybinding *keybinding_ref(struct keybinding *keybinding);
+// drops a reference, the keybinding is freed when the last one is dropped
 void destroy_keybinding(struct keybinding *keybinding);
 void destroy_keybinding0(void *keybinding);
 
+// returns a new reference to the same keybinding
 void *copy_keybinding(const void *keybinding_ptr, void *user_data);
 
 char *sort_keybinding_element(struct options *options, const char *binding_element);
@@ -2,12 +2,22 @@
 #define LAYOUT_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <lua.h>
 #include <lauxlib.h>
 #include "options.h"
 
+/* identifies the version of the init.lua a layout was loaded from */
+struct layout_source {
+    bool exists;
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+    int64_t size;
+};
+
 struct layout {
     const char *name;
+    struct layout_source source;
 
     // this is an option set by the user
     int current_max_area;
@@ -48,11 +58,28 @@ struct layout {
 struct layout *create_layout(lua_State *L);
 void destroy_layout(struct layout *lt);
 
+/* returns the layout with the given name as it is after executing its
+ * init.lua on top of the default layout. The file is only executed the first
+ * time a layout is requested, the result is cached until
+ * clear_layout_templates is called. */
+struct layout *get_layout_template(lua_State *L, const char *name);
+// create a layout for a tag from a template returned by get_layout_template
+struct layout *create_layout_from_template(lua_State *L, struct layout *template);
+void clear_layout_templates();
+bool layout_source_equal(struct layout_source *source1, struct layout_source *source2);
+/* moves the state that changes while the layout is used (layout data changed
+ * by resizing, n_master and the number of areas) from src_lt to dest_lt */
+void layout_take_state(struct layout *dest_lt, struct layout *src_lt);
+
 bool is_same_layout(struct layout layout, struct layout layout2);
 bool lua_is_layout_data(lua_State *L, const char *name);
 void lua_copy_table(lua_State *L, int *ref);
 // copy table and override old value
 void lua_copy_table_safe(lua_State *L, int *ref);
+/* like lua_copy_table_safe but the table isn't copied if it already is the
+ * table referenced by ref. The resize functions change the layout data in
+ * place and return it, so this way only the changed cells are touched. */
+void lua_copy_table_if_new(lua_State *L, int *ref);
 struct resize_constraints lua_toresize_constrains(lua_State *L);
 // copy layout and create new references
 void copy_layout(struct layout *dest_lt, struct layout *src_lt);
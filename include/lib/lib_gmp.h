@@ -19,12 +19,17 @@ int lib_gmp_pow(lua_State *L);
 int lib_gmp_lt(lua_State *L);
 int lib_gmp_le(lua_State *L);
 
-mpfr_ptr check_gmp(lua_State *L, int argn);
+// returns the value of a gmp number or a lua number as a double
+double check_gmp(lua_State *L, int argn);
 
 // static methods
 int lib_gmp_new(lua_State *L);
 int lib_gmp_max(lua_State *L);
 int lib_gmp_min(lua_State *L);
+// static getter
+int lib_gmp_get_precise(lua_State *L);
+// static setter
+int lib_gmp_set_precise(lua_State *L);
 // getter
 int lib_gmp_get_value(lua_State *L);
 
@@ -12,15 +12,18 @@ void create_lua_list(
         void *check_object(lua_State *L, int narg));
 void lua_load_list(lua_State *L);
 
-int lib_list_gc(lua_State *L);
 int lib_list_len(lua_State *L);
+int lib_list_pairs(lua_State *L);
+/* the iterator function of pairs. Its state is a table that to_table
+ * returned, lib_list2D uses it as well */
+int lib_list_snapshot_next(lua_State *L);
 // static methods
-int lib_list_to_array(lua_State *L);
 // methods
 int lib_list_find(lua_State *L);
 int lib_list_get(lua_State *L);
 int lib_list_repush(lua_State *L);
 int lib_list_swap(lua_State *L);
+int lib_list_to_table(lua_State *L);
 // getter
 int lib_list_length(lua_State *L);
 // setter
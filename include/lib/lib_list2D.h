@@ -11,14 +11,15 @@ void lua_load_list2D(lua_State *L);
 
 GPtrArray *check_list2D(lua_State *L, int argn);
 
+int lib_list2D_pairs(lua_State *L);
 // static methods
-int lib_list2D_to_array(lua_State *L);
 
 // methods
 int lib_list2D_find(lua_State *L);
 int lib_list2D_get(lua_State *L);
 int lib_list2D_repush(lua_State *L);
 int lib_list2D_swap(lua_State *L);
+int lib_list2D_to_table(lua_State *L);
 // getter
 int lib_list2D_length(lua_State *L);
 // setter
@@ -0,0 +1,17 @@
+#ifndef LIB_LOG_LEVEL_H
+#define LIB_LOG_LEVEL_H
+
+#include "lua.h"
+#include "lauxlib.h"
+
+void lua_load_log_level(lua_State *L);
+
+// getter
+int lib_log_level_get_silent(lua_State *L);
+int lib_log_level_get_error(lua_State *L);
+int lib_log_level_get_warning(lua_State *L);
+int lib_log_level_get_info(lua_State *L);
+int lib_log_level_get_debug(lua_State *L);
+int lib_log_level_get_trace(lua_State *L);
+
+#endif /* LIB_LOG_LEVEL_H */
@@ -3,6 +3,9 @@
 
 #include <lua.h>
 
+struct monitor;
+
+void create_lua_monitor(lua_State *L, struct monitor *m);
 void lua_load_monitor(lua_State *L);
 
 // static methods
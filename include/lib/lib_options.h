@@ -21,6 +21,9 @@ int lib_set_arrange_by_focus(lua_State *L);
 int lib_set_automatic_tag_naming(lua_State *L);
 int lib_set_border_color(lua_State *L);
 int lib_set_buttons(lua_State *L);
+int lib_set_callback_demote_threshold(lua_State *L);
+int lib_set_callback_instruction_limit(lua_State *L);
+int lib_set_callback_time_limit(lua_State *L);
 int lib_set_entry_position_function(lua_State *L);
 int lib_set_entry_focus_position_function(lua_State *L);
 int lib_set_float_border_width(lua_State *L);
@@ -43,5 +46,8 @@ int lib_set_default_layout(lua_State *L);
 
 int lib_get_sloppy_focus(lua_State *L);
 int lib_get_inner_gaps(lua_State *L);
+int lib_get_callback_demote_threshold(lua_State *L);
+int lib_get_callback_instruction_limit(lua_State *L);
+int lib_get_callback_time_limit(lua_State *L);
 
 #endif /* LIB_CONFIG_H */
@@ -14,7 +14,13 @@ int lib_server_quit(lua_State *L);
 
 // getter
 int lib_server_get_default_layout_ring(lua_State *L);
+int lib_server_get_ipc_drop_oldest(lua_State *L);
+int lib_server_get_ipc_queue_limit(lua_State *L);
+int lib_server_get_log_level(lua_State *L);
 // setter
 int lib_server_set_default_layout_ring(lua_State *L);
+int lib_server_set_ipc_drop_oldest(lua_State *L);
+int lib_server_set_ipc_queue_limit(lua_State *L);
+int lib_server_set_log_level(lua_State *L);
 
 #endif /* LIB_SERVER_H */
@@ -0,0 +1,37 @@
+#ifndef LUA_WATCHDOG_H
+#define LUA_WATCHDOG_H
+
+#include <stdbool.h>
+#include <lua.h>
+
+/*
+ * The watchdog enforces the budget that is defined by
+ * opt.callback_instruction_limit and opt.callback_time_limit on lua callbacks.
+ * Only the outermost call is measured, callbacks that are invoked from within
+ * another callback count towards the budget of their caller.
+ * */
+
+/* has to be called right before lua_pcall with the function and its nargs
+ * arguments on top of the stack */
+void lua_watchdog_begin(lua_State *L, int nargs);
+/* has to be called right after lua_pcall. Returns true if the call was aborted
+ * because it exceeded its budget. The error message is left on the stack just
+ * like lua_pcall does. */
+bool lua_watchdog_end(lua_State *L, int lua_status);
+/* returns true if the budget of the current outermost call is exhausted */
+bool lua_watchdog_is_exceeded();
+
+/* If the function on the stack was demoted because it exceeded its budget too
+ * often it is popped together with its nargs arguments without calling it.
+ * Returns true if the call was skipped. */
+bool lua_watchdog_skip(lua_State *L, int nargs);
+
+/* calls in between don't have a budget, this is used while loading config
+ * files */
+void lua_watchdog_suspend();
+void lua_watchdog_resume();
+
+/* forget which callbacks were demoted, used when the config is reloaded */
+void lua_watchdog_reset();
+
+#endif /* LUA_WATCHDOG_H */
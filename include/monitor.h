@@ -5,6 +5,7 @@
 #include <wlr/types/wlr_scene.h>
 
 #include "server.h"
+#include "stats.h"
 #include "bitset/bitset.h"
 
 struct cursor;
@@ -14,6 +15,7 @@ struct monitor {
     struct wlr_output_damage *damage;
 
     struct wl_listener frame;
+    struct wl_listener needs_frame;
     struct wl_listener damage_frame;
     struct wl_listener destroy;
     /* monitor area, layout-relative */
@@ -24,6 +26,11 @@ struct monitor {
     struct wlr_scene_output *scene_output;
 
     int tag_id;
+
+    // monotonic time in microseconds of the first damage that wasn't
+    // committed yet, 0 if there is none
+    int64_t damage_time;
+    struct frame_stats frame_stats;
 };
 
 struct monrule {
@@ -0,0 +1,21 @@
+#ifndef MSGPACK_H
+#define MSGPACK_H
+
+#include <glib.h>
+#include <json.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* A MessagePack encoding of json objects. Every json value has exactly one
+ * MessagePack representation, so decoding an encoded object returns an equal
+ * object. */
+
+// appends the MessagePack encoding of object to out, NULL is encoded as nil
+void msgpack_encode(GByteArray *out, json_object *object);
+/* returns the object encoded in data or NULL if data isn't a single valid
+ * MessagePack value. nil is decoded as NULL, so check *error to tell it apart
+ * from malformed data */
+json_object *msgpack_decode(const uint8_t *data, size_t len, bool *error);
+
+#endif /* MSGPACK_H */
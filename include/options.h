@@ -12,6 +12,8 @@
 struct tag;
 struct keybinding;
 struct layout;
+struct rule;
+struct rule_index;
 
 enum hidden_edge_borders {
     NONE,
@@ -45,6 +47,8 @@ struct options {
 
     GPtrArray *tag_names;
     GPtrArray *rules;
+    // compiled from rules when it is needed, NULL if rules changed
+    struct rule_index *rule_index;
     GPtrArray *mon_rules;
 
     // timeout in milliseconds
@@ -65,16 +69,31 @@ struct options {
 
     int new_position_func_ref;
     int new_focus_position_func_ref;
+
+    // budget of a single lua callback, 0 means unlimited
+    int callback_instruction_limit;
+    // in milliseconds
+    int callback_time_limit;
+    // number of violations after which a callback is skipped, 0 means never
+    int callback_demote_threshold;
 };
 
 struct options *create_options();
 void destroy_options(struct options *options);
 void options_reset(struct options *options);
 void load_default_keybindings(struct options *options);
+/* releases the cached default keybindings, has to be called while the lua
+ * state they were compiled in still exists */
+void reset_default_keybindings();
 GPtrArray *create_tagnames();
 void copy_options(struct options *dest_option, struct options *src_option);
+/* compares all options except for the lists (tag names, rules, mon rules
+ * and keybindings) */
+bool options_scalars_equal(struct options *options1, struct options *options2);
 
 void options_add_keybinding(struct options *options, struct keybinding *keybinding);
+void options_add_rule(struct options *options, struct rule *rule);
+struct rule_index *options_get_rule_index(struct options *options);
 
 int tag_get_new_position(struct tag *tag);
 int tag_get_new_focus_position(struct tag *tag);
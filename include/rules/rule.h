@@ -1,18 +1,54 @@
 #ifndef RULE_H
 #define RULE_H
 
+#include <glib.h>
+
 #include "container.h"
 
+// how the class and the title of a rule are compared
+enum rule_match {
+    RULE_MATCH_SUBSTRING,
+    RULE_MATCH_EXACT,
+    RULE_MATCH_PREFIX,
+    RULE_MATCH_SUFFIX,
+    RULE_MATCH_REGEX,
+};
+
+// the properties of a container that rules are matched against
+enum rule_field {
+    RULE_FIELD_APP_ID = 1 << 0,
+    RULE_FIELD_TITLE = 1 << 1,
+};
+
 struct rule {
     char *id;
     char *title;
+    enum rule_match match;
+    // only set if match is RULE_MATCH_REGEX
+    GRegex *id_regex;
+    GRegex *title_regex;
     int lua_func_ref;
 };
 
-struct rule *create_rule(const char *id, const char *title, int lua_func_ref);
+/* rules compiled into lookup structures so that a container is matched
+ * against all rules in a single pass over its app_id and title */
+struct rule_index;
+
+/* returns NULL and sets error if match is RULE_MATCH_REGEX and id or title
+ * isn't a valid regex */
+struct rule *create_rule(const char *id, const char *title,
+        enum rule_match match, int lua_func_ref, GError **error);
 void destroy_rule(struct rule *rule);
+/* returns -1 if str isn't one of "substring", "exact", "prefix", "suffix"
+ * and "regex" */
+int rule_match_from_string(const char *str);
+
+struct rule_index *create_rule_index(GPtrArray *rules);
+void destroy_rule_index(struct rule_index *index);
 
-void apply_rule(struct rule *rule, struct container *con);
-void apply_rules(GPtrArray *rules, struct container *con);
+/* applies all matching rules that have a pattern for one of the changed
+ * fields. Rules without any pattern are applied when the app_id changes */
+void apply_rules(struct rule_index *index, struct container *con,
+        enum rule_field changed);
 
 #endif /* RULE_H */
@@ -23,6 +23,7 @@
 #include "input_manager.h"
 #include "utils/coreUtils.h"
 #include "bitset/bitset.h"
+#include "stats.h"
 
 struct server {
     bool is_running;
@@ -134,6 +135,8 @@ struct server {
 
     int ipc_socket;
 
+    struct stats stats;
+
     struct container *grab_c;
     enum wlr_edges grabbed_edges;
 #if JAPOKWM_HAS_XWAYLAND
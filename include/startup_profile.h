@@ -0,0 +1,46 @@
+#ifndef STARTUP_PROFILE_H
+#define STARTUP_PROFILE_H
+
+#include <stdbool.h>
+
+/*
+ * Startup is always timed since it only costs a few clock_gettime calls, the
+ * breakdown is only printed if japokwm was started with --startup-profile.
+ * */
+
+enum startup_phase {
+    STARTUP_PHASE_INIT_LUA_API,
+    STARTUP_PHASE_LOAD_LUA_API,
+    STARTUP_PHASE_INIT_BACKEND,
+    STARTUP_PHASE_SETUP_SERVER,
+    STARTUP_PHASE_START_BACKEND,
+    STARTUP_PHASE_INIT_UTILS,
+    STARTUP_PHASE_LOAD_CONFIG,
+    STARTUP_PHASE_CREATE_FIRST_MONITOR,
+    STARTUP_PHASE_COUNT,
+};
+
+enum startup_event {
+    STARTUP_EVENT_EVENT_LOOP,
+    STARTUP_EVENT_FIRST_FRAME,
+    STARTUP_EVENT_XWAYLAND_READY,
+    STARTUP_EVENT_COUNT,
+};
+
+/* the start of the process, everything is measured relative to it */
+void startup_profile_init();
+void startup_profile_enable_output();
+
+void startup_phase_begin(enum startup_phase phase);
+void startup_phase_end(enum startup_phase phase);
+/* only the first occurrence of an event is recorded */
+void startup_event_mark(enum startup_event event);
+
+/* returns the duration of the phase in milliseconds or -1 if it didn't
+ * finish */
+double startup_phase_get_duration(enum startup_phase phase);
+/* returns the time since the start in milliseconds or -1 if the event didn't
+ * happen yet */
+double startup_event_get_time(enum startup_event event);
+
+#endif /* STARTUP_PROFILE_H */
@@ -0,0 +1,71 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+
+/* counters that are collected while the compositor is running. They are
+ * only ever incremented from the main thread. */
+struct lua_stats {
+    // callbacks called through lua_call_safe at the outermost level
+    uint64_t calls;
+    // callbacks that were aborted because they exceeded their budget
+    uint64_t budget_violations;
+    // callbacks that were demoted because they exceeded their budget too often
+    uint64_t demoted_callbacks;
+    // calls of demoted callbacks that were skipped
+    uint64_t skipped_calls;
+    // batches of changes on_update was emitted for
+    uint64_t update_events;
+    // arranged tags whose layout didn't change
+    uint64_t skipped_updates;
+};
+
+struct ipc_stats {
+    // get_tree and get_tags replies that were served from the cache
+    uint64_t snapshot_hits;
+    // get_tree and get_tags replies that had to be serialized
+    uint64_t snapshot_builds;
+    // outermost transactions, every ipc command runs in one
+    uint64_t transactions;
+    // calls of arrange() that were merged into the arrange of a transaction
+    uint64_t deferred_arranges;
+    // queued events that were replaced by a newer event about the same object
+    uint64_t coalesced_events;
+    // queued events that were dropped because a client didn't read them
+    uint64_t dropped_events;
+    // clients that were disconnected because their queue was too long
+    uint64_t overflow_disconnects;
+    // replies and events that were encoded, once per encoding
+    uint64_t payload_encodes;
+    // events that weren't sent to a client because none of its filters matched
+    uint64_t filtered_events;
+    // writev calls that flushed queued messages to a client
+    uint64_t write_calls;
+};
+
+/* frame statistics of a single output, times are in microseconds */
+struct frame_stats {
+    // frame events emitted by the output
+    uint64_t frames;
+    // frames where wlr_scene_output_commit failed
+    uint64_t skipped_frames;
+    // frames where nothing was damaged
+    uint64_t no_damage_frames;
+
+    int64_t last_commit_time;
+    int64_t max_commit_time;
+    int64_t total_commit_time;
+
+    // time from the first damage after the last commit to the next commit
+    int64_t last_damage_to_commit;
+    int64_t max_damage_to_commit;
+    int64_t total_damage_to_commit;
+    uint64_t damaged_commits;
+};
+
+struct stats {
+    struct lua_stats lua;
+    struct ipc_stats ipc;
+};
+
+#endif /* STATS_H */
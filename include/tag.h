@@ -57,6 +57,7 @@ struct tagset;
 
 struct tag {
     GPtrArray *loaded_layouts;
+    // interned with g_intern_string so that they outlive the layouts
     const char *current_layout;
     const char *previous_layout;
 
@@ -132,6 +133,10 @@ void push_layout(struct tag *tag, const char *layout_name);
 void set_default_layout(struct tag *tag);
 void focus_layout(struct tag *tag, const char *name);
 int tag_load_layout(struct tag *tag, const char *layout_name);
+/* recreates the loaded layouts of the tags from the layout templates. The
+ * state of layouts whose init.lua didn't change is kept. Returns true if a
+ * layout changed. */
+bool tags_reload_loaded_layouts(GList *tags);
 void tag_remove_loaded_layouts(struct tag *tag);
 void tags_remove_loaded_layouts(GList *tags);
 void tag_rename(struct tag *tag, const char *name);
@@ -0,0 +1,20 @@
+#ifndef TRANSACTION_H
+#define TRANSACTION_H
+
+#include <stdbool.h>
+
+/*
+ * A transaction groups changes that should become visible at once. While a
+ * transaction is active arrange() only marks the layout as outdated and
+ * ipc events are collected. Committing the outermost transaction arranges
+ * once and sends every collected event once.
+ * */
+
+void transaction_begin();
+void transaction_commit();
+bool transaction_is_active();
+/* returns true if arrange() is called inside a transaction and has to be
+ * deferred until the transaction is committed */
+bool transaction_defer_arrange();
+
+#endif /* TRANSACTION_H */
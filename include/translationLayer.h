@@ -20,13 +20,13 @@ struct layout;
 #define create_class(L, extra_meta, functions, methods, variable_setter, variable_getter, name)\
     do {\
         luaL_newmetatable(L, name); {\
-            luaL_setfuncs(L, meta, 0);\
             lua_pushstring(L, "__metatable");\
             lua_pushstring(L, "access restricted to metatable");\
             lua_settable(L, -3);\
-            luaL_setfuncs(L, extra_meta, 0);\
             add_table(L, "setter", variable_setter, -1);\
             add_table(L, "getter", variable_getter, -1);\
+            set_class_accessors(L);\
+            luaL_setfuncs(L, extra_meta, 0);\
             \
             luaL_setfuncs(L, methods, 0);\
             luaL_setfuncs(L, functions, 0);\
@@ -36,10 +36,10 @@ struct layout;
 #define create_static_accessor(L, name, functions, static_setter, static_getter)\
     do {\
         lua_createtable(L, 0, 0); {\
-            luaL_setfuncs(L, meta, 0);\
             luaL_setfuncs(L, functions, 0);\
             add_table(L, "setter", static_setter, -1);\
             add_table(L, "getter", static_getter, -1);\
+            set_class_accessors(L);\
             \
             lua_createtable(L, 0, 0);\
             lua_insert(L, -2);\
@@ -51,7 +51,6 @@ struct layout;
 #define create_enum(L, variable_getter, name)\
     do {\
         luaL_newmetatable(L, name); {\
-            luaL_setfuncs(L, meta, 0);\
             lua_pushstring(L, "__metatable");\
             lua_pushstring(L, "access restricted to metatable");\
             lua_settable(L, -3);\
@@ -61,6 +60,7 @@ struct layout;
             lua_settable(L, -3);\
             \
             add_table(L, "getter", variable_getter, -1);\
+            set_class_accessors(L);\
         } lua_pop(L, 1);\
     } while(0)
 
@@ -83,11 +83,13 @@ struct layout;
 #define CONFIG_FOCUS_SET "japokwm.focus_set"
 #define CONFIG_GEOMETRY "japokwm.geometry"
 #define CONFIG_GMP "japokwm.gmp"
+#define CONFIG_GMP_MPFR "japokwm.gmp_mpfr"
 #define CONFIG_INFO "japokwm.info"
 #define CONFIG_LAYOUT "japokwm.layout"
 #define CONFIG_LIST "japokwm.list"
 #define CONFIG_LIST2D "japokwm.list2D"
 #define CONFIG_LOCAL_OPTIONS "japokwm.local.options"
+#define CONFIG_LOG_LEVEL "japokwm.log_level"
 #define CONFIG_MONITOR "japokwm.monitor"
 #define CONFIG_OPTIONS "japokwm.options"
 #define CONFIG_OUTPUT_TRANSFORM "japokwm.output_transform"
@@ -102,8 +104,11 @@ void load_lua_api(lua_State *L);
 void init_global_config_variables(lua_State *L);
 void init_local_config_variables(lua_State *L, struct layout *lt);
 
-extern const struct luaL_Reg meta[];
-
+/* sets __index and __newindex of the metatable on top of the stack to
+ * closures that hold the metatable and its getter and setter tables as
+ * upvalues, so that property access doesn't need any string keyed lookups of
+ * the metatable */
+void set_class_accessors(lua_State *L);
 int get_lua_value(lua_State *L);
 int set_lua_value(lua_State *L);
 
@@ -0,0 +1,26 @@
+#ifndef AHO_CORASICK_H
+#define AHO_CORASICK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* an Aho-Corasick automaton finds all occurrences of a set of patterns in a
+ * text in a single pass over the text */
+struct aho_corasick;
+
+/* called for every occurrence of a pattern. The occurrence is
+ * text[start..end) */
+typedef void aho_corasick_match_func(int id, size_t start, size_t end,
+        void *data);
+
+struct aho_corasick *create_aho_corasick();
+void destroy_aho_corasick(struct aho_corasick *ac);
+
+/* adds a pattern that is reported with the given id. Patterns can't be added
+ * after the automaton was built */
+void aho_corasick_add(struct aho_corasick *ac, const char *pattern, int id);
+void aho_corasick_build(struct aho_corasick *ac);
+void aho_corasick_match(struct aho_corasick *ac, const char *text,
+        aho_corasick_match_func match_func, void *data);
+
+#endif /* AHO_CORASICK_H */
@@ -0,0 +1,18 @@
+#ifndef BYTECODE_CACHE_H
+#define BYTECODE_CACHE_H
+
+#include <lua.h>
+
+/* compiled lua chunks are cached in $XDG_CACHE_HOME/japokwm (or
+ * ~/.cache/japokwm). A cached chunk is only used if the path, the
+ * modification time and the size of the source file and the lua version
+ * match, otherwise the file is compiled again and the cache is updated. */
+
+/* works like luaL_loadfile */
+int bytecode_cache_loadfile(lua_State *L, const char *file);
+/* makes require load modules found in package.path through the cache */
+void bytecode_cache_install_searcher(lua_State *L);
+/* returns the path of the cache file that belongs to file */
+char *bytecode_cache_get_path(const char *file);
+
+#endif /* BYTECODE_CACHE_H */
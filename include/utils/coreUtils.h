@@ -109,6 +109,10 @@ void lua_get_default_resize_data(lua_State *L);
 void list_clear(GPtrArray *array, void (*destroy_func)(void *));
 void wlr_list_cat(GPtrArray *dest, GPtrArray *src);
 void list_insert(GPtrArray *array, int i, void *item);
+// returns true if both lists contain equal strings in the same order
+bool string_lists_equal(GPtrArray *list1, GPtrArray *list2);
+// wlr_box_equal isn't available in all supported wlroots versions
+bool box_equal(const struct wlr_box *box1, const struct wlr_box *box2);
 
 /* return true on success and false on failure */
 bool list_remove(GPtrArray *array, int (*compare)(const void *, const void *), const void *cmp_to);
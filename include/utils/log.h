@@ -0,0 +1,66 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdarg.h>
+
+/*
+ * Messages are formatted into a fixed size ring buffer by the main thread and
+ * written to the error file by a separate thread so that logging never
+ * blocks the compositor. If the ring buffer is full new messages are dropped.
+ * */
+
+enum log_level {
+    LOG_LEVEL_SILENT = 0,
+    LOG_LEVEL_ERROR = 1,
+    LOG_LEVEL_WARNING = 2,
+    LOG_LEVEL_INFO = 3,
+    LOG_LEVEL_DEBUG = 4,
+    LOG_LEVEL_TRACE = 5,
+};
+
+// messages above this level are removed at compile time
+#ifndef LOG_COMPILE_LEVEL
+#if DEBUG
+#define LOG_COMPILE_LEVEL LOG_LEVEL_TRACE
+#else
+#define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
+#endif
+#endif
+
+// messages above this level are dropped at runtime
+extern enum log_level log_runtime_level;
+
+#ifdef __GNUC__
+#define LOG_ATTRIB_PRINTF(start, end) __attribute__((format(printf, start, end)))
+#else
+#define LOG_ATTRIB_PRINTF(start, end)
+#endif
+
+#define log_print(level, fmt, ...) \
+    do { \
+        if ((level) <= LOG_COMPILE_LEVEL && (level) <= log_runtime_level) \
+            _log_print(level, fmt, ##__VA_ARGS__); \
+    } while (0)
+
+#define log_error(fmt, ...) log_print(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#define log_warning(fmt, ...) log_print(LOG_LEVEL_WARNING, fmt, ##__VA_ARGS__)
+#define log_info(fmt, ...) log_print(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#define log_debug(fmt, ...) log_print(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#define log_trace(fmt, ...) log_print(LOG_LEVEL_TRACE, fmt, ##__VA_ARGS__)
+
+/* starts the thread that writes messages to the error file */
+void log_init();
+/* writes all pending messages and stops the thread */
+void log_finalize();
+
+void log_set_level(enum log_level level);
+enum log_level log_get_level();
+const char *log_level_to_string(enum log_level level);
+/* returns the number of messages that were dropped because the ring buffer
+ * was full */
+unsigned long log_get_dropped_count();
+
+/* only call this from the main thread */
+void _log_print(enum log_level level, const char *fmt, ...) LOG_ATTRIB_PRINTF(2, 3);
+
+#endif /* LOG_H */
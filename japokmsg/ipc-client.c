@@ -105,7 +105,7 @@ struct ipc_response *ipc_recv_response(int socketfd) {
     total = 0;
     while (total < response->size) {
         ssize_t received = recv(socketfd, payload + total, response->size - total, 0);
-        if (received < 0) {
+        if (received <= 0) {
             sway_abort("Unable to receive IPC response");
         }
         total += received;
@@ -126,19 +126,29 @@ void free_ipc_response(struct ipc_response *response) {
     free(response);
 }
 
-char *ipc_single_command(int socketfd, uint32_t type, const char *payload, uint32_t *len) {
+static void write_all(int socketfd, const char *data, size_t len) {
+    size_t total = 0;
+    while (total < len) {
+        ssize_t written = write(socketfd, data + total, len - total);
+        if (written == -1) {
+            sway_abort("Unable to send IPC message");
+        }
+        total += written;
+    }
+}
+
+void ipc_send_message(int socketfd, uint32_t type, const char *payload, uint32_t len) {
     char data[IPC_HEADER_SIZE];
     memcpy(data, ipc_magic, sizeof(ipc_magic));
-    memcpy(data + sizeof(ipc_magic), len, sizeof(*len));
-    memcpy(data + sizeof(ipc_magic) + sizeof(*len), &type, sizeof(type));
+    memcpy(data + sizeof(ipc_magic), &len, sizeof(len));
+    memcpy(data + sizeof(ipc_magic) + sizeof(len), &type, sizeof(type));
 
-    if (write(socketfd, data, IPC_HEADER_SIZE) == -1) {
-        sway_abort("Unable to send IPC header");
-    }
+    write_all(socketfd, data, IPC_HEADER_SIZE);
+    write_all(socketfd, payload, len);
+}
 
-    if (write(socketfd, payload, *len) == -1) {
-        sway_abort("Unable to send IPC payload");
-    }
+char *ipc_single_command(int socketfd, uint32_t type, const char *payload, uint32_t *len) {
+    ipc_send_message(socketfd, type, payload, *len);
 
     struct ipc_response *resp = ipc_recv_response(socketfd);
     char *response = resp->payload;
@@ -30,6 +30,10 @@ int ipc_open_socket(const char *socket_path);
  * the length of the buffer returned from sway.
  */
 char *ipc_single_command(int socketfd, uint32_t type, const char *payload, uint32_t *len);
+/**
+ * Sends a single IPC message without waiting for the response.
+ */
+void ipc_send_message(int socketfd, uint32_t type, const char *payload, uint32_t len);
 /**
  * Receives a single IPC response and returns an ipc_response.
  */
@@ -6,6 +6,13 @@
 enum ipc_command_type {
     // i3 command types - see i3's I3_REPLY_TYPE constants
     IPC_COMMAND = 0,
+    IPC_GET_TAGS = 1,
+    IPC_GET_TREE = 4,
+
+    // japokwm specific message types
+    IPC_GET_STATS = 200,
+    IPC_SET_ENCODING = 201,
+    IPC_QUERY = 202,
 };
 
 #endif
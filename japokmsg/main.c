@@ -9,8 +9,11 @@
 #include <sys/socket.h>
 #include <sys/time.h>
 #include <ctype.h>
+#include <errno.h>
+#include <poll.h>
 #include <unistd.h>
 #include <json.h>
+#include "msgpack.h"
 #include "stringop.h"
 #include "ipc-client.h"
 #include "log.h"
@@ -68,6 +71,10 @@ static void pretty_print(int type, json_object *resp) {
     printf("%s\n", json_object_to_json_string_ext(resp,
                 JSON_C_TO_STRING_PRETTY | JSON_C_TO_STRING_SPACED));
 
+    if (type != IPC_COMMAND) {
+        return;
+    }
+
     json_object *obj;
     size_t len = json_object_array_length(resp);
     for (size_t i = 0; i < len; ++i) {
@@ -76,14 +83,150 @@ static void pretty_print(int type, json_object *resp) {
     }
 }
 
+// replies are MessagePack instead of json after this
+static void set_msgpack_encoding(int socketfd, bool quiet) {
+    const char *encoding = "msgpack";
+    uint32_t len = strlen(encoding);
+    char *resp = ipc_single_command(socketfd, IPC_SET_ENCODING, encoding, &len);
+    json_object *obj = json_tokener_parse(resp);
+    bool ok = obj && success(obj, false);
+    json_object_put(obj);
+    free(resp);
+
+    if (!ok) {
+        if (quiet) {
+            exit(EXIT_FAILURE);
+        }
+        sway_abort("japokwm doesn't support the msgpack encoding");
+    }
+}
+
+// returns NULL if the payload can't be decoded
+static json_object *decode_reply(const char *payload, uint32_t len,
+        bool msgpack) {
+    if (msgpack) {
+        return msgpack_decode((const uint8_t *)payload, len, NULL);
+    }
+    return json_tokener_parse(payload);
+}
+
+#define BATCH_READ_SIZE 4096
+
+// returns false if the reply reports a failure
+static bool print_batch_reply(struct ipc_response *resp, bool quiet,
+        bool msgpack) {
+    json_object *obj = decode_reply(resp->payload, resp->size, msgpack);
+    bool ok = obj && success(obj, true);
+
+    if (!quiet) {
+        // decoded replies are printed as json
+        printf("%s\n", msgpack
+                ? json_object_to_json_string_ext(obj, JSON_C_TO_STRING_PLAIN)
+                : resp->payload);
+        fflush(stdout);
+    }
+    json_object_put(obj);
+    return ok;
+}
+
+// sends every complete line in buf and moves the rest to the start of buf
+static size_t send_batch_lines(int socketfd, uint32_t type, char *buf,
+        size_t len, size_t *in_flight) {
+    char *start = buf;
+    char *end;
+    while ((end = memchr(start, '\n', buf + len - start))) {
+        size_t line_len = end - start;
+        if (line_len > 0) {
+            ipc_send_message(socketfd, type, start, line_len);
+            (*in_flight)++;
+        }
+        start = end + 1;
+    }
+
+    size_t rest = buf + len - start;
+    memmove(buf, start, rest);
+    return rest;
+}
+
+/* Reads newline-delimited messages from stdin and sends each of them over
+ * the same connection as soon as it is complete. Replies are printed one per
+ * line in the order of the messages as they arrive, so japokmsg can also be
+ * used as a coprocess. */
+static int run_batch(int socketfd, uint32_t type, bool quiet, bool msgpack) {
+    size_t size = BATCH_READ_SIZE;
+    size_t len = 0;
+    char *buf = malloc(size);
+    if (!buf) {
+        sway_abort("Unable to allocate batch buffer");
+    }
+
+    int ret = 0;
+    bool eof = false;
+    size_t in_flight = 0;
+    while (!eof || in_flight > 0) {
+        struct pollfd fds[] = {
+            {.fd = eof ? -1 : STDIN_FILENO, .events = POLLIN},
+            {.fd = in_flight > 0 ? socketfd : -1, .events = POLLIN},
+        };
+        if (poll(fds, 2, -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            sway_abort("Unable to poll stdin and the IPC socket");
+        }
+
+        if (fds[1].revents) {
+            struct ipc_response *resp = ipc_recv_response(socketfd);
+            in_flight--;
+            if (!print_batch_reply(resp, quiet, msgpack)) {
+                ret = 2;
+            }
+            free_ipc_response(resp);
+        }
+
+        if (!fds[0].revents) {
+            continue;
+        }
+
+        if (size - len < BATCH_READ_SIZE) {
+            size *= 2;
+            buf = realloc(buf, size);
+            if (!buf) {
+                sway_abort("Unable to allocate batch buffer");
+            }
+        }
+        ssize_t received = read(STDIN_FILENO, buf + len, size - len);
+        if (received == -1 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            eof = true;
+            // the last line doesn't need a trailing newline
+            if (len > 0) {
+                buf[len++] = '\n';
+            }
+        } else {
+            len += received;
+        }
+        len = send_batch_lines(socketfd, type, buf, len, &in_flight);
+    }
+
+    free(buf);
+    return ret;
+}
+
 int main(int argc, char **argv) {
     static bool quiet = false;
+    static bool batch = false;
+    static bool msgpack = false;
     char *socket_path = NULL;
     char *cmdtype = NULL;
 
     log_init(JAPOKWM_INFO, NULL);
 
     static struct option long_options[] = {
+        {"batch", no_argument, NULL, 'b'},
+        {"encoding", required_argument, NULL, 'e'},
         {"help", no_argument, NULL, 'h'},
         {"quiet", no_argument, NULL, 'q'},
         {"config", required_argument, NULL, 'c'},
@@ -96,6 +239,8 @@ int main(int argc, char **argv) {
     const char *usage =
         "Usage: japokmsg [options] [message]\n"
         "\n"
+        "  -b, --batch            Send every line of stdin as a message.\n"
+        "  -e, --encoding <enc>   Receive replies as json or msgpack.\n"
         "  -h, --help             Show help message and quit.\n"
         "  -m, --monitor          Monitor until killed (-t SUBSCRIBE only)\n"
         "  -q, --quiet            Be quiet.\n"
@@ -106,11 +251,21 @@ int main(int argc, char **argv) {
     int c;
     while (1) {
         int option_index = 0;
-        c = getopt_long(argc, argv, "hmqs:t:v", long_options, &option_index);
+        c = getopt_long(argc, argv, "be:hmqs:t:v", long_options, &option_index);
         if (c == -1) {
             break;
         }
         switch (c) {
+            case 'b': // Batch
+                batch = true;
+                break;
+            case 'e': // Encoding
+                if (strcasecmp(optarg, "msgpack") == 0) {
+                    msgpack = true;
+                } else if (strcasecmp(optarg, "json") != 0) {
+                    sway_abort("Unknown encoding %s", optarg);
+                }
+                break;
             case 'q': // Quiet
                 quiet = true;
                 break;
@@ -147,10 +302,37 @@ int main(int argc, char **argv) {
 
     if (strcasecmp(cmdtype, "command") == 0) {
         type = IPC_COMMAND;
+    } else if (strcasecmp(cmdtype, "get_tags") == 0
+            || strcasecmp(cmdtype, "get_workspaces") == 0) {
+        type = IPC_GET_TAGS;
+    } else if (strcasecmp(cmdtype, "get_tree") == 0) {
+        type = IPC_GET_TREE;
+    } else if (strcasecmp(cmdtype, "get_stats") == 0) {
+        type = IPC_GET_STATS;
+    } else if (strcasecmp(cmdtype, "query") == 0) {
+        type = IPC_QUERY;
+    } else {
+        if (quiet) {
+            exit(EXIT_FAILURE);
+        }
+        sway_abort("Unknown message type %s", cmdtype);
     }
 
     free(cmdtype);
 
+    if (batch) {
+        int socketfd = ipc_open_socket(socket_path);
+        struct timeval timeout = {.tv_sec = 3, .tv_usec = 0};
+        ipc_set_recv_timeout(socketfd, timeout);
+        if (msgpack) {
+            set_msgpack_encoding(socketfd, quiet);
+        }
+        int ret = run_batch(socketfd, type, quiet, msgpack);
+        close(socketfd);
+        free(socket_path);
+        return ret;
+    }
+
     char *command = NULL;
     if (optind < argc) {
         command = join_args(argv + optind, argc - optind);
@@ -162,16 +344,21 @@ int main(int argc, char **argv) {
     int socketfd = ipc_open_socket(socket_path);
     struct timeval timeout = {.tv_sec = 3, .tv_usec = 0};
     ipc_set_recv_timeout(socketfd, timeout);
+    if (msgpack) {
+        set_msgpack_encoding(socketfd, quiet);
+    }
     uint32_t len = strlen(command);
     char *resp = ipc_single_command(socketfd, type, command, &len);
 
     // pretty print the json
-    json_object *obj = json_tokener_parse(resp);
+    json_object *obj = decode_reply(resp, len, msgpack);
     if (obj == NULL) {
         if (!quiet) {
             fprintf(stderr, "ERROR: Could not parse json response from ipc. "
                     "This is a bug in japokwm.");
-            printf("%s\n", resp);
+            if (!msgpack) {
+                printf("%s\n", resp);
+            }
         }
         ret = 1;
     } else {
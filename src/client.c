@@ -184,7 +184,7 @@ void focus_client(struct seat *seat, struct client *old, struct client *c)
 void client_setsticky(struct client *c, BitSet *tags)
 {
     bitset_assign_bitset(&c->sticky_tags, tags);
-    ipc_event_tag();
+    ipc_event_tag("rename", container_get_current_tag(c->con), NULL);
 }
 
 float calc_ratio(float width, float height)
@@ -246,8 +246,10 @@ void client_handle_set_title(struct wl_listener *listener, void *data)
     struct tag *tag = container_get_tag(c->con);
     if (tag) {
         struct layout *lt = tag_get_layout(tag);
-        apply_rules(lt->options->rules, c->con);
+        struct rule_index *rule_index = options_get_rule_index(lt->options);
+        apply_rules(rule_index, c->con, RULE_FIELD_TITLE);
     }
+    ipc_event_window("title", c->con);
 }
 
 void client_handle_set_app_id(struct wl_listener *listener, void *data)
@@ -276,8 +278,10 @@ void client_handle_set_app_id(struct wl_listener *listener, void *data)
     struct tag *tag = container_get_tag(c->con);
     if (tag) {
         struct layout *lt = tag_get_layout(tag);
-        apply_rules(lt->options->rules, c->con);
+        struct rule_index *rule_index = options_get_rule_index(lt->options);
+        apply_rules(rule_index, c->con, RULE_FIELD_APP_ID);
     }
+    ipc_snapshot_invalidate_containers();
 }
 
 void reset_floating_client_borders(int border_px)
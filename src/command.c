@@ -5,6 +5,7 @@
 #include "utils/parseConfigUtils.h"
 #include "server.h"
 #include "tile/tileUtils.h"
+#include "transaction.h"
 #include "translationLayer.h"
 
 struct cmd_results *cmd_results_new(enum cmd_status status,
@@ -65,14 +66,25 @@ struct cmd_results *cmd_eval(const char *cmd)
 
 struct cmd_results *execute_command(char *cmd, struct wlr_seat *seat,
         struct container *con) {
+    transaction_begin();
     struct cmd_results *res = cmd_eval(cmd);
     arrange();
+    transaction_commit();
     return res;
 }
 
-char *cmd_results_to_json(struct cmd_results *results) {
-    json_object *result_array = json_object_new_array();
+struct cmd_results **execute_commands(char **cmds, size_t count) {
+    struct cmd_results **results = calloc(count, sizeof(*results));
+    transaction_begin();
+    for (size_t i = 0; i < count; i++) {
+        results[i] = cmd_eval(cmds[i]);
+    }
+    arrange();
+    transaction_commit();
+    return results;
+}
 
+static json_object *cmd_result_to_json(struct cmd_results *results) {
     json_object *root = json_object_new_object();
     json_object_object_add(root, "success",
             json_object_new_boolean(results->status == CMD_SUCCESS));
@@ -82,7 +94,18 @@ char *cmd_results_to_json(struct cmd_results *results) {
         json_object_object_add(
                 root, "error", json_object_new_string(results->error));
     }
-    json_object_array_add(result_array, root);
+    return root;
+}
+
+char *cmd_results_to_json(struct cmd_results *results) {
+    return cmd_results_list_to_json(&results, 1);
+}
+
+char *cmd_results_list_to_json(struct cmd_results **results, size_t count) {
+    json_object *result_array = json_object_new_array();
+    for (size_t i = 0; i < count; i++) {
+        json_object_array_add(result_array, cmd_result_to_json(results[i]));
+    }
 
     const char *json = json_object_to_json_string(result_array);
     char *res = strdup(json);
@@ -9,6 +9,7 @@
 #include "client.h"
 #include "container.h"
 #include "cursor.h"
+#include "event_handler.h"
 #include "list_sets/container_stack_set.h"
 #include "list_sets/list_set.h"
 #include "render.h"
@@ -28,6 +29,7 @@
 #include "lib/lib_layout.h"
 #include "lib/lib_geom.h"
 #include "root.h"
+#include "utils/log.h"
 
 static void add_container_to_tag(struct container *con, struct tag *tag);
 
@@ -103,7 +105,10 @@ void container_property_set_floating(struct container_property *property, bool f
 
 struct container *create_container(struct client *c, struct monitor *m, bool has_border)
 {
+    static uint32_t next_id = 1;
+
     struct container *con = calloc(1, sizeof(*con));
+    con->id = next_id++;
     con->client = c;
     c->con = con;
 
@@ -129,6 +134,10 @@ void destroy_container(struct container *con)
         server.grab_c = NULL;
     }
 
+    if (server.event_handler) {
+        event_handler_remove_container(server.event_handler, con);
+    }
+
     g_ptr_array_unref(con->properties);
     free(con);
 }
@@ -146,8 +155,9 @@ void add_container_to_tile(struct container *con)
 
     con->is_on_tile = true;
 
+    ipc_event_window("new", con);
     tag_update_names(server_get_tags());
-    ipc_event_tag();
+    ipc_event_tag("rename", get_tag(con->tag_id), NULL);
 }
 
 void remove_container_from_tile(struct container *con)
@@ -175,8 +185,9 @@ void remove_container_from_tile(struct container *con)
     }
 
     con->is_on_tile = false;
+    ipc_event_window("close", con);
     tag_update_names(server_get_tags());
-    ipc_event_tag();
+    ipc_event_tag("rename", tag, NULL);
 }
 
 void scale_box(struct wlr_box *box, float scale)
@@ -777,6 +788,7 @@ void container_set_tiled_geom(struct container *con, struct wlr_box geom)
     }
 
     con->prev_geom = con_geom;
+    ipc_snapshot_invalidate_containers();
 
     if (con->client->type == LAYER_SHELL) {
         con->global_geom = geom;
@@ -806,6 +818,7 @@ void container_set_floating_geom_at_tag(struct container *con,
 
     con->prev_geom = *con_geom;
     *con_geom = geom;
+    ipc_snapshot_invalidate_containers();
 }
 
 void container_set_floating_geom(struct container *con, struct wlr_box geom)
@@ -1241,7 +1254,7 @@ void container_resize_in_layout(
     struct container_property *property = container_get_property(con);
     struct wlr_box geom = property->geom;
     // struct wlr_box geom = container_get_current_geom(con);
-    printf("geom: %d %d %d %d\n", geom.x, geom.y, geom.width, geom.height);
+    log_trace("geom: %d %d %d %d", geom.x, geom.y, geom.width, geom.height);
 
     // geom.width = absolute_x_to_container_relative(geom, cursor->x - offsetx);
     // geom.height = absolute_y_to_container_relative(geom, cursor->y - offsety);
@@ -1265,7 +1278,7 @@ void container_resize_in_layout(
     if (grabbed_edges == WLR_EDGE_BOTTOM) {
         geom.height = cursor_y - geom.y;
     }
-    printf("new geom: %d %d %d %d\n", geom.x, geom.y, geom.width, geom.height);
+    log_trace("new geom: %d %d %d %d", geom.x, geom.y, geom.width, geom.height);
 
     // struct wlr_box test_geom = {
     //     .x = 2000,
@@ -1273,7 +1286,7 @@ void container_resize_in_layout(
     //     .width = 8000,
     //     .height = 8000,
     // };
-    printf("grabbed edges: %d\n", grabbed_edges);
+    log_trace("grabbed edges: %d", grabbed_edges);
     resize_container_in_layout(con, geom);
 }
 
@@ -1292,7 +1305,7 @@ void resize_container_in_layout(struct container *con, struct wlr_box geom)
         return;
     }
 
-    lua_copy_table_safe(L, &lt->lua_layout_copy_data_ref);
+    lua_copy_table_if_new(L, &lt->lua_layout_copy_data_ref);
     arrange();
 }
 
@@ -1447,8 +1460,8 @@ void move_container_to_tag(struct container *con, struct tag *tag)
 
     struct tag *old_tag = container_get_current_tag(con);
 
-    printf("old tag new con: %p\n", tag_get_focused_container(tag));
-    printf("tag new con: %p\n", tag_get_focused_container(tag));
+    log_trace("old tag new con: %p", (void *)tag_get_focused_container(tag));
+    log_trace("tag new con: %p", (void *)tag_get_focused_container(tag));
 
     arrange();
     tagset_reload(tag);
@@ -1469,7 +1482,8 @@ void move_container_to_tag(struct container *con, struct tag *tag)
     tagset_reload(old_tag);
     tagset_reload(tag);
 
-    ipc_event_tag();
+    ipc_event_window("move", con);
+    ipc_event_tag("rename", tag, old_tag);
 }
 
 static int get_distance_squared(int x1, int y1, int x2, int y2)
@@ -1525,16 +1539,16 @@ static enum wlr_edges geometry_get_nearest_edge_from_point(
             bottom_edge_distance_squared);
 
     if (min == left_edge_distance_squared) {
-        printf("left\n");
+        log_trace("left edge");
         return WLR_EDGE_LEFT;
     } else if (min == right_edge_distance_squared) {
-        printf("right\n");
+        log_trace("right edge");
         return WLR_EDGE_RIGHT;
     } else if (min == top_edge_distance_squared) {
-        printf("top\n");
+        log_trace("top edge");
         return WLR_EDGE_TOP;
     } else if (min == bottom_edge_distance_squared) {
-        printf("bottom\n");
+        log_trace("bottom edge");
         return WLR_EDGE_BOTTOM;
     } else {
         assert(false);
@@ -1559,17 +1573,17 @@ void container_resize_with_cursor(struct cursor *cursor)
             cursor->wlr_cursor->y);
     switch (edge) {
         case WLR_EDGE_LEFT:
-            printf("left\n");
+            log_trace("left edge");
             wlr_cursor_set_xcursor(wlr_cursor,
                     cursor->xcursor_mgr, "left_side");
             break;
         case WLR_EDGE_RIGHT:
-            printf("right\n");
+            log_trace("right edge");
             wlr_cursor_set_xcursor(wlr_cursor,
                     cursor->xcursor_mgr, "right_side");
             break;
         case WLR_EDGE_TOP:
-            printf("top\n");
+            log_trace("top edge");
             wlr_cursor_set_xcursor(wlr_cursor,
                     cursor->xcursor_mgr, "top_side");
             break;
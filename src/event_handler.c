@@ -1,16 +1,43 @@
 #include "event_handler.h"
 
 #include <lua.h>
+#include <string.h>
+#include <wayland-server-core.h>
 
 #include "utils/parseConfigUtils.h"
 #include "utils/coreUtils.h"
 #include "lib/lib_layout.h"
 #include "lib/lib_container.h"
+#include "lib/lib_monitor.h"
+#include "lib/lib_tag.h"
+#include "container.h"
 #include "layout.h"
 #include "monitor.h"
 #include "server.h"
 #include "tag.h"
 
+struct tag_state {
+    char *layout_name;
+    int n_area;
+    int n_master_abs;
+    int n_tiled;
+    int n_visible;
+    int n_hidden;
+    int n_floating;
+};
+
+struct monitor_state {
+    struct wlr_box geom;
+    int tag_id;
+};
+
+static void destroy_tag_state(void *data)
+{
+    struct tag_state *state = data;
+    free(state->layout_name);
+    free(state);
+}
+
 struct event_handler *create_event_handler()
 {
     struct event_handler *event_handler = calloc(1, sizeof(*event_handler));
@@ -19,6 +46,14 @@ struct event_handler *create_event_handler()
     event_handler->on_start_func_refs = g_ptr_array_new();
     event_handler->on_unfocus_func_refs = g_ptr_array_new();
     event_handler->on_update_func_refs = g_ptr_array_new();
+
+    event_handler->changed_tag_ids = g_ptr_array_new();
+    event_handler->changed_monitors = g_ptr_array_new();
+    event_handler->changed_containers = g_ptr_array_new();
+    event_handler->tag_states = g_hash_table_new_full(
+            g_direct_hash, g_direct_equal, NULL, destroy_tag_state);
+    event_handler->monitor_states = g_hash_table_new_full(
+            g_direct_hash, g_direct_equal, NULL, free);
     return event_handler;
 }
 
@@ -29,6 +64,16 @@ void destroy_event_handler(struct event_handler *event_handler)
     g_ptr_array_unref(event_handler->on_start_func_refs);
     g_ptr_array_unref(event_handler->on_unfocus_func_refs);
     g_ptr_array_unref(event_handler->on_update_func_refs);
+
+    if (event_handler->update_source) {
+        wl_event_source_remove(event_handler->update_source);
+    }
+    g_ptr_array_unref(event_handler->changed_tag_ids);
+    g_ptr_array_unref(event_handler->changed_monitors);
+    g_ptr_array_unref(event_handler->changed_containers);
+    g_hash_table_destroy(event_handler->tag_states);
+    g_hash_table_destroy(event_handler->monitor_states);
+    free(event_handler);
 }
 
 GPtrArray *event_name_to_signal(struct event_handler *event_handler,
@@ -70,14 +115,168 @@ static void emit_signal(GPtrArray *func_refs, int narg)
     lua_pop(L, narg);
 }
 
-void call_update_function(struct event_handler *ev, int n)
+static void clear_changes(struct event_handler *ev)
+{
+    g_ptr_array_set_size(ev->changed_tag_ids, 0);
+    g_ptr_array_set_size(ev->changed_monitors, 0);
+    g_ptr_array_set_size(ev->changed_containers, 0);
+}
+
+// [..., table]
+static void push_change_list(lua_State *L, const char *name, GPtrArray *list,
+        void (*create_lua_object)(lua_State *L, void *data))
+{
+    lua_createtable(L, list->len, 0);
+    int n = 0;
+    for (int i = 0; i < list->len; i++) {
+        void *data = g_ptr_array_index(list, i);
+        if (!data)
+            continue;
+        create_lua_object(L, data);
+        lua_rawseti(L, -2, ++n);
+    }
+    lua_setfield(L, -2, name);
+}
+
+static void create_lua_tag_object(lua_State *L, void *data)
+{
+    create_lua_tag(L, data);
+}
+
+static void create_lua_monitor_object(lua_State *L, void *data)
+{
+    create_lua_monitor(L, data);
+}
+
+static void create_lua_container_object(lua_State *L, void *data)
+{
+    create_lua_container(L, data);
+}
+
+static void emit_update(void *data)
 {
+    struct event_handler *ev = data;
+    ev->update_source = NULL;
+
     struct monitor *m = server_get_selected_monitor();
+    if (!m || ev->on_update_func_refs->len == 0) {
+        clear_changes(ev);
+        return;
+    }
+
+    // tags aren't referenced directly so that they can be looked up safely
+    GPtrArray *changed_tags = g_ptr_array_new();
+    for (int i = 0; i < ev->changed_tag_ids->len; i++) {
+        int id = GPOINTER_TO_INT(g_ptr_array_index(ev->changed_tag_ids, i));
+        g_ptr_array_add(changed_tags, get_tag(id));
+    }
+
     struct tag *tag = monitor_get_active_tag(m);
     struct layout *lt = tag_get_layout(tag);
-
     create_lua_layout(L, lt);
-    emit_signal(ev->on_update_func_refs, 1);
+
+    lua_createtable(L, 0, 3);
+    push_change_list(L, "tags", changed_tags, create_lua_tag_object);
+    push_change_list(L, "monitors", ev->changed_monitors,
+            create_lua_monitor_object);
+    push_change_list(L, "containers", ev->changed_containers,
+            create_lua_container_object);
+    g_ptr_array_unref(changed_tags);
+
+    // changes made by the handlers belong to the next batch
+    clear_changes(ev);
+    server.stats.lua.update_events++;
+    emit_signal(ev->on_update_func_refs, 2);
+}
+
+static void schedule_update(struct event_handler *ev)
+{
+    if (ev->update_source || !server.wl_event_loop)
+        return;
+    ev->update_source =
+        wl_event_loop_add_idle(server.wl_event_loop, emit_update, ev);
+}
+
+static void add_change(struct event_handler *ev, GPtrArray *list, void *data)
+{
+    if (!g_ptr_array_find(list, data, NULL)) {
+        g_ptr_array_add(list, data);
+    }
+    schedule_update(ev);
+}
+
+void event_handler_update_tag(struct event_handler *ev, struct tag *tag)
+{
+    struct layout *lt = tag_get_layout(tag);
+    struct tag_state state = {
+        .layout_name = (char *)lt->name,
+        .n_area = lt->n_area,
+        .n_master_abs = lt->n_master_abs,
+        .n_tiled = lt->n_tiled,
+        .n_visible = lt->n_visible,
+        .n_hidden = lt->n_hidden,
+        .n_floating = lt->n_floating,
+    };
+
+    void *key = GINT_TO_POINTER(tag->id);
+    struct tag_state *prev_state = g_hash_table_lookup(ev->tag_states, key);
+    if (prev_state
+            && g_strcmp0(prev_state->layout_name, state.layout_name) == 0
+            && prev_state->n_area == state.n_area
+            && prev_state->n_master_abs == state.n_master_abs
+            && prev_state->n_tiled == state.n_tiled
+            && prev_state->n_visible == state.n_visible
+            && prev_state->n_hidden == state.n_hidden
+            && prev_state->n_floating == state.n_floating) {
+        server.stats.lua.skipped_updates++;
+        return;
+    }
+
+    struct tag_state *new_state = malloc(sizeof(*new_state));
+    *new_state = state;
+    new_state->layout_name = g_strdup(state.layout_name);
+    g_hash_table_insert(ev->tag_states, key, new_state);
+
+    add_change(ev, ev->changed_tag_ids, key);
+}
+
+void event_handler_update_monitor(struct event_handler *ev, struct monitor *m)
+{
+    struct monitor_state state = {
+        .geom = monitor_get_active_geom(m),
+        .tag_id = m->tag_id,
+    };
+
+    struct monitor_state *prev_state = g_hash_table_lookup(ev->monitor_states, m);
+    if (prev_state
+            && prev_state->tag_id == state.tag_id
+            && box_equal(&prev_state->geom, &state.geom)) {
+        return;
+    }
+
+    struct monitor_state *new_state = malloc(sizeof(*new_state));
+    *new_state = state;
+    g_hash_table_insert(ev->monitor_states, m, new_state);
+
+    add_change(ev, ev->changed_monitors, m);
+}
+
+void event_handler_mark_container(struct event_handler *ev,
+        struct container *con)
+{
+    add_change(ev, ev->changed_containers, con);
+}
+
+void event_handler_remove_monitor(struct event_handler *ev, struct monitor *m)
+{
+    g_ptr_array_remove(ev->changed_monitors, m);
+    g_hash_table_remove(ev->monitor_states, m);
+}
+
+void event_handler_remove_container(struct event_handler *ev,
+        struct container *con)
+{
+    g_ptr_array_remove(ev->changed_containers, con);
 }
 
 void call_create_container_function(struct event_handler *ev, int n)
@@ -10,12 +10,14 @@
 #include "json_object.h"
 #include "wlr-layer-shell-unstable-v1-protocol.h"
 #include "ipc/ipc-json.h"
+#include "ipc/ipc.h"
 #include "server.h"
 #include "container.h"
 #include "client.h"
 #include "tag.h"
 #include "monitor.h"
 #include "utils/coreUtils.h"
+#include "utils/log.h"
 #include "stringop.h"
 
 static json_object *ipc_json_create_rect(struct wlr_box *box) {
@@ -322,8 +324,8 @@ json_object *ipc_json_describe_bar_config() {
 
 json_object *ipc_json_describe_tag(const char *name, bool is_active_tag, struct monitor *m)
 {
-    struct wlr_box box;
-    box = m->geom;
+    // tags that aren't on any monitor have no geometry
+    struct wlr_box box = m ? m->geom : (struct wlr_box){0};
 
     char *s = strdup(name);
 
@@ -369,12 +371,18 @@ json_object *ipc_json_describe_monitor(struct monitor *m)
 
 json_object *ipc_json_describe_container(struct container *con)
 {
-    struct wlr_box geom = container_get_current_geom(con);
+    struct wlr_box geom;
+    if (con) {
+        geom = container_get_current_geom(con);
+    }
     json_object *object = ipc_json_create_node(
-            5, con ? con->client->title : NULL, true, NULL,
+            con ? con->id : 5, con ? con->client->title : NULL, true, NULL,
             con ? &geom : NULL);
 
     json_object_object_add(object, "type", json_object_new_string("con"));
+    json_object_object_add(object, "app_id",
+            con && con->client->app_id
+            ? json_object_new_string(con->client->app_id) : NULL);
 
     json_object *children = json_object_new_array();
     json_object_object_add(object, "nodes", children);
@@ -406,3 +414,131 @@ json_object *ipc_json_describe_selected_container(struct monitor *m)
 
     return root_object;
 }
+
+static json_object *ipc_json_describe_frame_stats(struct monitor *m)
+{
+    struct frame_stats *stats = &m->frame_stats;
+    uint64_t commits = stats->frames - stats->skipped_frames;
+
+    json_object *object = json_object_new_object();
+    json_object_object_add(object, "name",
+            json_object_new_string(m->wlr_output->name));
+    json_object_object_add(object, "frames",
+            json_object_new_int64(stats->frames));
+    json_object_object_add(object, "skipped_frames",
+            json_object_new_int64(stats->skipped_frames));
+    json_object_object_add(object, "no_damage_frames",
+            json_object_new_int64(stats->no_damage_frames));
+
+    json_object *commit = json_object_new_object();
+    json_object_object_add(commit, "last_us",
+            json_object_new_int64(stats->last_commit_time));
+    json_object_object_add(commit, "max_us",
+            json_object_new_int64(stats->max_commit_time));
+    json_object_object_add(commit, "avg_us", json_object_new_int64(
+                commits ? stats->total_commit_time / commits : 0));
+    json_object_object_add(object, "commit", commit);
+
+    json_object *damage = json_object_new_object();
+    json_object_object_add(damage, "last_us",
+            json_object_new_int64(stats->last_damage_to_commit));
+    json_object_object_add(damage, "max_us",
+            json_object_new_int64(stats->max_damage_to_commit));
+    json_object_object_add(damage, "avg_us", json_object_new_int64(
+                stats->damaged_commits
+                ? stats->total_damage_to_commit / stats->damaged_commits
+                : 0));
+    json_object_object_add(object, "damage_to_commit", damage);
+
+    return object;
+}
+
+static json_object *ipc_json_describe_client(struct ipc_client *client)
+{
+    json_object *object = json_object_new_object();
+    json_object_object_add(object, "fd", json_object_new_int(client->fd));
+    json_object_object_add(object, "encoding", json_object_new_string(
+                client->encoding == IPC_ENCODING_MSGPACK ? "msgpack" : "json"));
+    json_object_object_add(object, "filters",
+            json_object_new_int64(client->filters->len));
+    json_object_object_add(object, "queued_messages",
+            json_object_new_int64(g_queue_get_length(client->write_queue)));
+    json_object_object_add(object, "queued_bytes",
+            json_object_new_int64(client->queued_bytes));
+    json_object_object_add(object, "max_queued_bytes",
+            json_object_new_int64(client->stats.max_queued_bytes));
+    json_object_object_add(object, "coalesced_events",
+            json_object_new_int64(client->stats.coalesced_events));
+    json_object_object_add(object, "dropped_events",
+            json_object_new_int64(client->stats.dropped_events));
+    return object;
+}
+
+json_object *ipc_json_describe_stats()
+{
+    json_object *object = json_object_new_object();
+
+    struct lua_stats *lua_stats = &server.stats.lua;
+    json_object *lua = json_object_new_object();
+    json_object_object_add(lua, "calls",
+            json_object_new_int64(lua_stats->calls));
+    json_object_object_add(lua, "budget_violations",
+            json_object_new_int64(lua_stats->budget_violations));
+    json_object_object_add(lua, "demoted_callbacks",
+            json_object_new_int64(lua_stats->demoted_callbacks));
+    json_object_object_add(lua, "skipped_calls",
+            json_object_new_int64(lua_stats->skipped_calls));
+    json_object_object_add(lua, "update_events",
+            json_object_new_int64(lua_stats->update_events));
+    json_object_object_add(lua, "skipped_updates",
+            json_object_new_int64(lua_stats->skipped_updates));
+    json_object_object_add(object, "lua", lua);
+
+    struct ipc_stats *ipc_stats = &server.stats.ipc;
+    json_object *ipc = json_object_new_object();
+    json_object_object_add(ipc, "snapshot_hits",
+            json_object_new_int64(ipc_stats->snapshot_hits));
+    json_object_object_add(ipc, "snapshot_builds",
+            json_object_new_int64(ipc_stats->snapshot_builds));
+    json_object_object_add(ipc, "transactions",
+            json_object_new_int64(ipc_stats->transactions));
+    json_object_object_add(ipc, "deferred_arranges",
+            json_object_new_int64(ipc_stats->deferred_arranges));
+    json_object_object_add(ipc, "coalesced_events",
+            json_object_new_int64(ipc_stats->coalesced_events));
+    json_object_object_add(ipc, "dropped_events",
+            json_object_new_int64(ipc_stats->dropped_events));
+    json_object_object_add(ipc, "overflow_disconnects",
+            json_object_new_int64(ipc_stats->overflow_disconnects));
+    json_object_object_add(ipc, "payload_encodes",
+            json_object_new_int64(ipc_stats->payload_encodes));
+    json_object_object_add(ipc, "filtered_events",
+            json_object_new_int64(ipc_stats->filtered_events));
+    json_object_object_add(ipc, "write_calls",
+            json_object_new_int64(ipc_stats->write_calls));
+
+    json_object *clients = json_object_new_array();
+    GPtrArray *ipc_clients = ipc_get_clients();
+    for (int i = 0; ipc_clients && i < ipc_clients->len; i++) {
+        struct ipc_client *client = g_ptr_array_index(ipc_clients, i);
+        json_object_array_add(clients, ipc_json_describe_client(client));
+    }
+    json_object_object_add(ipc, "clients", clients);
+    json_object_object_add(object, "ipc", ipc);
+
+    json_object *log = json_object_new_object();
+    json_object_object_add(log, "level",
+            json_object_new_string(log_level_to_string(log_get_level())));
+    json_object_object_add(log, "dropped_messages",
+            json_object_new_int64(log_get_dropped_count()));
+    json_object_object_add(object, "log", log);
+
+    json_object *outputs = json_object_new_array();
+    for (int i = 0; i < server.mons->len; i++) {
+        struct monitor *m = g_ptr_array_index(server.mons, i);
+        json_object_array_add(outputs, ipc_json_describe_frame_stats(m));
+    }
+    json_object_object_add(object, "outputs", outputs);
+
+    return object;
+}
@@ -3,9 +3,11 @@
 #include "json_types.h"
 #include <linux/input-event-codes.h>
 #include <assert.h>
+#include <ctype.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <json.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -24,260 +26,558 @@
 #include "tag.h"
 #include "client.h"
 #include "command.h"
+#include "list_sets/container_stack_set.h"
 #include "monitor.h"
+#include "utils/coreUtils.h"
 
-static int ipc_socket = -1;
-static struct sockaddr_un *ipc_sockaddr = NULL;
-static GPtrArray *ipc_client_list;
+void ipc_client_handle_command(struct ipc_client *client, uint32_t payload_length, enum ipc_command_type payload_type);
 
-// Macro to generate a bitmask for an event. 
-// It shifts 1 to the left by the lower 7 bits of the event value.
+int handle_client_payload(struct ipc_client *client) {
+    // Process the pending command
+    uint32_t pending_length = client->pending_length;
+    enum ipc_command_type pending_type = client->pending_type;
+    client->pending_length = 0;
+    ipc_client_handle_command(client, pending_length, pending_type);
 
-struct sockaddr_un *ipc_user_sockaddr(void);
-int ipc_handle_connection(int fd, uint32_t mask, void *data);
-int ipc_client_handle_writable(int client_fd, uint32_t mask, void *data);
-void ipc_client_disconnect(struct ipc_client *client);
-void ipc_client_handle_command(struct ipc_client *client, uint32_t payload_length, enum ipc_command_type payload_type);
+    return 0;
+}
 
-void ipc_init(struct wl_event_loop *wl_event_loop) {
-    ipc_socket = socket(AF_UNIX, SOCK_STREAM, 0);
-    if (ipc_socket == -1) {
-        printf("Unable to create IPC socket\n");
-    }
-    if (fcntl(ipc_socket, F_SETFD, FD_CLOEXEC) == -1) {
-        printf("Unable to set CLOEXEC on IPC socket\n");
+enum ipc_snapshot_type {
+    IPC_SNAPSHOT_TAGS,
+    IPC_SNAPSHOT_TREE,
+    IPC_SNAPSHOT_COUNT,
+};
+
+// a reply that is valid until it is invalidated
+struct ipc_snapshot {
+    struct ipc_payload payload;
+    bool dirty;
+};
+
+static struct ipc_snapshot snapshots[IPC_SNAPSHOT_COUNT] = {
+    [IPC_SNAPSHOT_TAGS] = {.dirty = true},
+    [IPC_SNAPSHOT_TREE] = {.dirty = true},
+};
+
+void ipc_snapshot_invalidate_tags() {
+    snapshots[IPC_SNAPSHOT_TAGS].dirty = true;
+    snapshots[IPC_SNAPSHOT_TREE].dirty = true;
+}
+
+void ipc_snapshot_invalidate_containers() {
+    snapshots[IPC_SNAPSHOT_TREE].dirty = true;
+}
+
+static json_object *describe_snapshot(enum ipc_snapshot_type type) {
+    switch (type) {
+        case IPC_SNAPSHOT_TAGS:
+            return ipc_json_describe_tagsets();
+        case IPC_SNAPSHOT_TREE:
+            return ipc_json_describe_selected_container(
+                    server_get_selected_monitor());
+        default:
+            return NULL;
     }
-    if (fcntl(ipc_socket, F_SETFL, O_NONBLOCK) == -1) {
-        printf("Unable to set NONBLOCK on IPC socket\n");
+}
+
+static struct ipc_snapshot *get_snapshot(enum ipc_snapshot_type type) {
+    struct ipc_snapshot *snapshot = &snapshots[type];
+    if (!snapshot->dirty) {
+        server.stats.ipc.snapshot_hits++;
+        return snapshot;
     }
 
-    ipc_sockaddr = ipc_user_sockaddr();
+    ipc_payload_finish(&snapshot->payload);
+    ipc_payload_init(&snapshot->payload, describe_snapshot(type),
+            JSON_C_TO_STRING_SPACED);
+    snapshot->dirty = false;
+
+    server.stats.ipc.snapshot_builds++;
+    return snapshot;
+}
+
+static void send_snapshot(struct ipc_client *client,
+        enum ipc_command_type payload_type, enum ipc_snapshot_type type) {
+    struct ipc_snapshot *snapshot = get_snapshot(type);
+    ipc_send_payload(client, payload_type, &snapshot->payload);
+}
+
+// the last state of every tag and container that was sent as a delta
+static GHashTable *tag_states = NULL;
+static GHashTable *window_states = NULL;
 
-    unlink(ipc_sockaddr->sun_path);
-    if (bind(ipc_socket, (struct sockaddr *)ipc_sockaddr, sizeof(*ipc_sockaddr)) == -1) {
-        printf("Unable to bind IPC socket\n");
+static GHashTable *get_states(GHashTable **states) {
+    if (!*states) {
+        *states = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                NULL, (GDestroyNotify)json_object_put);
     }
+    return *states;
+}
 
-    if (listen(ipc_socket, 3) == -1) {
-        printf("Unable to listen on IPC socket\n");
+static void reset_delta_states() {
+    if (tag_states) {
+        g_hash_table_remove_all(tag_states);
+    }
+    if (window_states) {
+        g_hash_table_remove_all(window_states);
     }
+}
 
-    // Set SWAY IPC socket path so that waybar automatically shows
-    // tags(tags)
-    setenv("SWAYSOCK", ipc_sockaddr->sun_path, 1);
-    setenv("JAPOKWMSOCK", ipc_sockaddr->sun_path, 1);
+/* returns the id and the fields of object that changed since the last delta
+ * of the object with the same id */
+static json_object *describe_delta(GHashTable *states, uint32_t id,
+        json_object *object) {
+    json_object *delta = json_object_new_object();
+    json_object_object_add(delta, "id", json_object_new_int64(id));
+
+    json_object *prev = g_hash_table_lookup(states, GUINT_TO_POINTER(id));
+    json_object_object_foreach(object, key, value) {
+        json_object *prev_value;
+        if (prev && json_object_object_get_ex(prev, key, &prev_value)
+                && json_object_equal(prev_value, value)) {
+            continue;
+        }
+        json_object_object_add(delta, key, json_object_get(value));
+    }
 
-    ipc_client_list = g_ptr_array_new();
+    g_hash_table_insert(states, GUINT_TO_POINTER(id), json_object_get(object));
+    return delta;
+}
 
-    wl_event_loop_add_fd(wl_event_loop, ipc_socket,
-            WL_EVENT_READABLE, ipc_handle_connection, wl_event_loop);
+/* a queued event is superseded by a newer one with the same change of the
+ * same object */
+static void send_event(enum ipc_command_type event, json_object *object,
+        json_object *delta, struct ipc_event_info *info, long id) {
+    struct ipc_payload payload;
+    struct ipc_payload delta_payload;
+    ipc_payload_init(&payload, object, JSON_C_TO_STRING_SPACED);
+    ipc_payload_init(&delta_payload, delta, JSON_C_TO_STRING_PLAIN);
+
+    char *coalesce_key = g_strdup_printf("%s:%ld", info->change, id);
+    ipc_send_event_payloads(&payload, &delta_payload, event, info, coalesce_key);
+    g_free(coalesce_key);
+
+    ipc_payload_finish(&payload);
+    ipc_payload_finish(&delta_payload);
 }
 
-struct sockaddr_un *ipc_user_sockaddr(void) {
-    struct sockaddr_un *ipc_sockaddr = malloc(sizeof(struct sockaddr_un));
-    if (ipc_sockaddr == NULL) {
-        printf("Can't allocate ipc_sockaddr\n");
+// tags that aren't shown are described as if they were on the selected monitor
+static struct monitor *get_tag_event_monitor(struct tag *tag) {
+    struct monitor *m = tag_get_monitor(tag);
+    if (!m) {
+        m = server_get_selected_monitor();
     }
+    return m;
+}
 
-    ipc_sockaddr->sun_family = AF_UNIX;
-    int path_size = sizeof(ipc_sockaddr->sun_path);
+static const char *get_output_name(struct monitor *m) {
+    return m ? m->wlr_output->name : NULL;
+}
 
-    // Env var typically set by logind, e.g. "/run/user/<user-id>"
-    const char *dir = getenv("XDG_RUNTIME_DIR");
-    if (!dir) {
-        dir = "/tmp";
+static json_object *describe_tag(struct tag *tag) {
+    if (!tag) {
+        return NULL;
     }
-    if (path_size <= snprintf(ipc_sockaddr->sun_path, path_size,
-            "%s/japokwm-ipc.%u.%i.sock", dir, getuid(), getpid())) {
-        printf("Socket path won't fit into ipc_sockaddr->sun_path\n");
+    struct monitor *m = get_tag_event_monitor(tag);
+    if (!m) {
+        return NULL;
     }
 
-    return ipc_sockaddr;
+    json_object *object = ipc_json_describe_tag(tag->name, tag_is_active(tag), m);
+    json_object_object_add(object, "id", json_object_new_int64(tag->id));
+    json_object_object_add(object, "visible",
+            json_object_new_boolean(tag_is_visible(tag, m)));
+    return object;
 }
 
-int ipc_handle_connection(int fd, uint32_t mask, void *data) {
-    struct wl_event_loop *wl_event_loop = data;
-    (void) fd;
-    int client_fd = accept(ipc_socket, NULL, NULL);
-    if (client_fd == -1) {
-        printf("Unable to accept IPC client connection\n");
-        return 0;
+static json_object *describe_tag_delta(struct tag *tag, json_object *object) {
+    if (!object) {
+        return NULL;
     }
+    return describe_delta(get_states(&tag_states), tag->id, object);
+}
+
+static json_object *describe_window(struct container *con) {
+    json_object *object = ipc_json_describe_container(con);
+
+    struct monitor *m = container_get_monitor(con);
+    bool focused = m && monitor_get_focused_container(m) == con;
+    json_object_object_add(object, "focused", json_object_new_boolean(focused));
+    return object;
+}
 
-    if (fcntl(client_fd, F_SETFD, FD_CLOEXEC) == -1) {
-        printf("Unable to set CLOEXEC on IPC client socket\n");
-        close(client_fd);
-        return 0;
+static void update_container_visibility() {
+    for (int i = server.container_stack->len-1; i >= 0; i--) {
+        struct container *con = g_ptr_array_index(server.container_stack, i);
+        struct monitor *m = server_get_selected_monitor();
+        bool viewable = container_viewable_on_monitor(m, con);
+        struct wlr_scene_node *node = container_get_scene_node(con);
+        wlr_scene_node_set_enabled(node, viewable);
     }
-    if (fcntl(client_fd, F_SETFL, O_NONBLOCK) == -1) {
-        printf("Unable to set NONBLOCK on IPC client socket\n");
-        close(client_fd);
-        return 0;
+}
+
+// an event that was collected while a transaction is active
+struct pending_event {
+    enum ipc_command_type event;
+    char *change;
+    // the tag or the container, -1 if the event has none
+    int64_t id;
+    int64_t old_id;
+    // the payloads of events about containers that don't exist anymore
+    bool is_close;
+    struct ipc_payload payload;
+    struct ipc_payload delta;
+    // what the payloads of a close event are about
+    char *output;
+    int64_t tag_id;
+    char *app_id;
+};
+
+// NULL unless events are held back
+static GPtrArray *pending_events = NULL;
+
+static void destroy_pending_event(void *data) {
+    struct pending_event *pending = data;
+    free(pending->change);
+    ipc_payload_finish(&pending->payload);
+    ipc_payload_finish(&pending->delta);
+    free(pending->output);
+    free(pending->app_id);
+    free(pending);
+}
+
+/* collects the event unless the same change of the same object is already
+ * collected */
+static struct pending_event *add_pending_event(enum ipc_command_type event,
+        const char *change, int64_t id, int64_t old_id) {
+    for (int i = 0; i < pending_events->len; i++) {
+        struct pending_event *pending = g_ptr_array_index(pending_events, i);
+        if (pending->event == event && pending->id == id
+                && strcmp(pending->change, change) == 0) {
+            return pending;
+        }
     }
 
-    struct ipc_client *client = malloc(sizeof(struct ipc_client));
-    if (!client) {
-        printf("Unable to allocate ipc client\n");
-        close(client_fd);
-        return 0;
+    struct pending_event *pending = calloc(1, sizeof(*pending));
+    pending->event = event;
+    pending->change = strdup(change);
+    pending->id = id;
+    pending->old_id = old_id;
+    g_ptr_array_add(pending_events, pending);
+    return pending;
+}
+
+static struct container *get_container_by_id(uint32_t id) {
+    for (int i = 0; i < server.container_stack->len; i++) {
+        struct container *con = g_ptr_array_index(server.container_stack, i);
+        if (con->id == id) {
+            return con;
+        }
     }
-    client->pending_length = 0;
-    client->fd = client_fd;
-    client->subscribed_events = 0;
-    client->event_source = wl_event_loop_add_fd(wl_event_loop,
-            client_fd, WL_EVENT_READABLE, ipc_client_handle_readable, client);
-    client->writable_event_source = NULL;
-
-    client->write_buffer_size = 128;
-    client->write_buffer_len = 0;
-    client->write_buffer = malloc(client->write_buffer_size);
-    if (!client->write_buffer) {
-        printf("Unable to allocate ipc client write buffer\n");
-        close(client_fd);
-        return 0;
-    }
-
-    g_ptr_array_add(ipc_client_list, client);
-    return 0;
+    return NULL;
 }
 
-// Forward declaration of helper functions
-static int read_client_header(int client_fd, struct ipc_client *client);
-static int get_available_read_data(int client_fd, struct ipc_client *client);
+static void get_tag_event_info(struct ipc_event_info *info, const char *change,
+        struct tag *tag, struct tag *old) {
+    *info = (struct ipc_event_info){
+        .change = change,
+        .output = tag ? get_output_name(get_tag_event_monitor(tag)) : NULL,
+        .tag_id = tag ? tag->id : -1,
+        .object_ids = {tag ? tag->id : -1, old ? old->id : -1},
+    };
+}
 
+static void get_window_event_info(struct ipc_event_info *info,
+        const char *change, struct container *con) {
+    *info = (struct ipc_event_info){
+        .change = change,
+        .output = get_output_name(container_get_monitor(con)),
+        .tag_id = con->tag_id,
+        .app_id = con->client->app_id,
+        .object_ids = {con->id, -1},
+    };
+}
 
-static int get_available_read_data(int client_fd, struct ipc_client *client) {
-    int read_available;
-    if (ioctl(client_fd, FIONREAD, &read_available) == -1) {
-        printf("Unable to read IPC socket buffer size\n");
-        ipc_client_disconnect(client);
-        return 1; // Return 1 to indicate an error occurred
+static void send_tag_event(const char *change, struct tag *tag, struct tag *old) {
+    struct ipc_event_info info;
+    get_tag_event_info(&info, change, tag, old);
+    bool has_full = ipc_has_subscribers(IPC_EVENT_TAG, false, &info);
+    bool has_delta = ipc_has_subscribers(IPC_EVENT_TAG, true, &info);
+
+    if (has_full || has_delta) {
+        json_object *current_object = describe_tag(tag);
+        json_object *old_object = describe_tag(old);
+
+        json_object *delta = NULL;
+        if (has_delta) {
+            delta = json_object_new_object();
+            json_object_object_add(delta, "change", json_object_new_string(change));
+            json_object_object_add(delta, "current",
+                    describe_tag_delta(tag, current_object));
+            json_object_object_add(delta, "old",
+                    describe_tag_delta(old, old_object));
+        }
+
+        json_object *event = NULL;
+        if (has_full) {
+            event = json_object_new_object();
+            json_object_object_add(event, "change", json_object_new_string(change));
+            json_object_object_add(event, "current", json_object_get(current_object));
+            json_object_object_add(event, "old", json_object_get(old_object));
+        }
+
+        json_object_put(current_object);
+        json_object_put(old_object);
+        send_event(IPC_EVENT_TAG, event, delta, &info, tag ? (long)tag->id : -1);
     }
-    return 0; // Return 0 to indicate success
+
+    // TODO: this doesn't belong here
+    // HACK: just for the time being
+    update_container_visibility();
 }
 
+static void describe_window_event(struct ipc_event_info *info,
+        struct container *con, json_object **event, json_object **delta) {
+    const char *change = info->change;
+    bool has_full = ipc_has_subscribers(IPC_EVENT_WINDOW, false, info);
+    bool has_delta = ipc_has_subscribers(IPC_EVENT_WINDOW, true, info);
 
-static int read_client_header(int client_fd, struct ipc_client *client) {
-    uint8_t buf[IPC_HEADER_SIZE];
-    ssize_t received = recv(client_fd, buf, IPC_HEADER_SIZE, 0);
-    if (received == -1) {
-        printf("Unable to receive header from IPC client\n");
-        ipc_client_disconnect(client);
-        return 0;
+    *event = NULL;
+    *delta = NULL;
+    if (!has_full && !has_delta) {
+        return;
     }
 
-    // Validate the IPC header
-    if (memcmp(buf, ipc_magic, sizeof(ipc_magic)) != 0) {
-        printf("IPC header check failed\n");
-        ipc_client_disconnect(client);
-        return 0;
+    json_object *container = describe_window(con);
+    if (has_delta) {
+        *delta = json_object_new_object();
+        json_object_object_add(*delta, "change", json_object_new_string(change));
+        json_object_object_add(*delta, "container",
+                describe_delta(get_states(&window_states), con->id, container));
     }
+    if (has_full) {
+        *event = json_object_new_object();
+        json_object_object_add(*event, "change", json_object_new_string(change));
+        json_object_object_add(*event, "container", json_object_get(container));
+    }
+    json_object_put(container);
+}
 
-    // Extract and store header information
-    memcpy(&client->pending_length, buf + sizeof(ipc_magic), sizeof(uint32_t));
-    memcpy(&client->pending_type, buf + sizeof(ipc_magic) + sizeof(uint32_t), sizeof(uint32_t));
-
-    return handle_client_payload(client);
+static void hold_close_event(struct container *con) {
+    struct pending_event *pending =
+        add_pending_event(IPC_EVENT_WINDOW, "close", con->id, -1);
+
+    struct ipc_event_info info;
+    get_window_event_info(&info, "close", con);
+
+    json_object *event;
+    json_object *delta;
+    describe_window_event(&info, con, &event, &delta);
+    ipc_payload_finish(&pending->payload);
+    ipc_payload_finish(&pending->delta);
+    free(pending->output);
+    free(pending->app_id);
+    pending->is_close = true;
+    ipc_payload_init(&pending->payload, event, JSON_C_TO_STRING_SPACED);
+    ipc_payload_init(&pending->delta, delta, JSON_C_TO_STRING_PLAIN);
+    pending->output = info.output ? strdup(info.output) : NULL;
+    pending->tag_id = info.tag_id;
+    pending->app_id = info.app_id ? strdup(info.app_id) : NULL;
 }
 
-int handle_client_payload(struct ipc_client *client) {
-    if (client->pending_length <= 0) {
-        return 0;
+static void forget_window(uint32_t id) {
+    if (window_states) {
+        g_hash_table_remove(window_states, GUINT_TO_POINTER(id));
     }
+    ipc_forget_object(IPC_EVENT_WINDOW, id);
+}
 
-    // Process the pending command
-    uint32_t pending_length = client->pending_length;
-    enum ipc_command_type pending_type = client->pending_type;
-    client->pending_length = 0;
-    ipc_client_handle_command(client, pending_length, pending_type);
+void ipc_event_tag(const char *change, struct tag *tag, struct tag *old) {
+    ipc_snapshot_invalidate_tags();
 
-    return 0;
+    if (pending_events) {
+        add_pending_event(IPC_EVENT_TAG, change,
+                tag ? (int64_t)tag->id : -1, old ? (int64_t)old->id : -1);
+        return;
+    }
+    send_tag_event(change, tag, old);
 }
 
-void ipc_event_tag() {
-    ipc_send_event("", IPC_EVENT_TAG);
+void ipc_event_window(const char *change, struct container *con) {
+    ipc_snapshot_invalidate_containers();
 
-    // TODO: this doesn't belong here
-    // HACK: just for the time being
-    // update container visibility
-    for (int i = server.container_stack->len-1; i >= 0; i--) {
-        struct container *con = g_ptr_array_index(server.container_stack, i);
-        struct monitor *m = server_get_selected_monitor();
-        bool viewable = container_viewable_on_monitor(m, con);
-        struct wlr_scene_node *node = container_get_scene_node(con);
-        wlr_scene_node_set_enabled(node, viewable);
+    if (!con) {
+        return;
+    }
+
+    bool is_close = strcmp(change, "close") == 0;
+    if (pending_events) {
+        if (is_close) {
+            hold_close_event(con);
+        } else {
+            add_pending_event(IPC_EVENT_WINDOW, change, con->id, -1);
+        }
+        return;
     }
-}
 
-int ipc_client_handle_writable(int client_fd, uint32_t mask, void *data) {
-    struct ipc_client *client = data;
+    struct ipc_event_info info;
+    get_window_event_info(&info, change, con);
 
-    if (mask & WL_EVENT_ERROR) {
-        printf("IPC Client socket error, removing client\n");
-        ipc_client_disconnect(client);
-        return 0;
+    json_object *event;
+    json_object *delta;
+    describe_window_event(&info, con, &event, &delta);
+    if (event || delta) {
+        send_event(IPC_EVENT_WINDOW, event, delta, &info, con->id);
     }
 
-    if (mask & WL_EVENT_HANGUP) {
-        printf("Client %d hung up\n", client->fd);
-        ipc_client_disconnect(client);
-        return 0;
+    if (is_close) {
+        forget_window(con->id);
     }
+}
 
-    if (client->write_buffer_len <= 0) {
-        return 0;
+void ipc_events_hold() {
+    if (pending_events) {
+        return;
     }
+    pending_events = g_ptr_array_new_with_free_func(destroy_pending_event);
+}
 
-    ssize_t written = write(client->fd, client->write_buffer, client->write_buffer_len);
+static void send_pending_event(struct pending_event *pending) {
+    if (pending->is_close) {
+        struct ipc_event_info info = {
+            .change = pending->change,
+            .output = pending->output,
+            .tag_id = pending->tag_id,
+            .app_id = pending->app_id,
+            .object_ids = {pending->id, -1},
+        };
+        ipc_send_event_payloads(&pending->payload, &pending->delta,
+                pending->event, &info, NULL);
+        forget_window(pending->id);
+        return;
+    }
 
-    if (written == -1 && errno == EAGAIN) {
-        return 0;
-    } else if (written == -1) {
-        printf("Unable to send data from queue to IPC client\n");
-        ipc_client_disconnect(client);
-        return 0;
+    switch (pending->event) {
+        case IPC_EVENT_TAG:
+            {
+                struct tag *tag = pending->id >= 0 ? get_tag(pending->id) : NULL;
+                struct tag *old = pending->old_id >= 0 ? get_tag(pending->old_id) : NULL;
+                send_tag_event(pending->change, tag, old);
+            }
+            break;
+        case IPC_EVENT_WINDOW:
+            {
+                // the container may have been closed in the meantime
+                struct container *con = get_container_by_id(pending->id);
+                if (con) {
+                    ipc_event_window(pending->change, con);
+                }
+            }
+            break;
+        default:
+            break;
     }
+}
 
-    memmove(client->write_buffer, client->write_buffer + written, client->write_buffer_len - written);
-    client->write_buffer_len -= written;
+size_t ipc_events_pending_count() {
+    return pending_events ? pending_events->len : 0;
+}
 
-    if (client->write_buffer_len == 0 && client->writable_event_source) {
-        wl_event_source_remove(client->writable_event_source);
-        client->writable_event_source = NULL;
+void ipc_events_release() {
+    if (!pending_events) {
+        return;
     }
 
-    return 0;
+    // events sent now are not held back anymore
+    GPtrArray *events = pending_events;
+    pending_events = NULL;
+    for (int i = 0; i < events->len; i++) {
+        send_pending_event(g_ptr_array_index(events, i));
+    }
+    g_ptr_array_unref(events);
 }
 
-void ipc_client_disconnect(struct ipc_client *client) {
-    if (!(client != NULL)) {
+void ipc_event_output(struct monitor *m) {
+    ipc_snapshot_invalidate_tags();
+
+    struct ipc_event_info info = {
+        .change = "unspecified",
+        .output = get_output_name(m),
+        .tag_id = -1,
+        .object_ids = {-1, -1},
+    };
+    if (!ipc_has_subscribers(IPC_EVENT_OUTPUT, false, &info)
+            && !ipc_has_subscribers(IPC_EVENT_OUTPUT, true, &info)) {
         return;
     }
 
-    shutdown(client->fd, SHUT_RDWR);
+    // outputs are small, so delta subscribers get the same payload
+    json_object *event = json_object_new_object();
+    json_object_object_add(event, "change", json_object_new_string("unspecified"));
+    json_object_object_add(event, "output", ipc_json_describe_monitor(m));
+
+    struct ipc_payload payload;
+    ipc_payload_init(&payload, event, JSON_C_TO_STRING_SPACED);
+    ipc_send_event(&payload, IPC_EVENT_OUTPUT, &info);
+    ipc_payload_finish(&payload);
+}
 
-    printf("IPC Client %d disconnected\n", client->fd);
-    wl_event_source_remove(client->event_source);
-    if (client->writable_event_source) {
-        wl_event_source_remove(client->writable_event_source);
+/* returns the commands of a payload that is a json array of strings or NULL
+ * if the payload is a single command. No lua chunk starts with '[' */
+static json_object *parse_command_list(const char *buf) {
+    while (isspace((unsigned char)*buf)) {
+        buf++;
     }
-    size_t i = 0;
-    while (i < ipc_client_list->len && g_ptr_array_index(ipc_client_list, i) != client) {
-        i++;
+    if (*buf != '[') {
+        return NULL;
+    }
+
+    json_object *commands = json_tokener_parse(buf);
+    if (!json_object_is_type(commands, json_type_array)) {
+        json_object_put(commands);
+        return NULL;
     }
-    g_ptr_array_remove_index(ipc_client_list, i);
-    free(client->write_buffer);
-    close(client->fd);
-    free(client);
+    for (size_t i = 0; i < json_object_array_length(commands); i++) {
+        json_object *command = json_object_array_get_idx(commands, i);
+        if (!json_object_is_type(command, json_type_string)) {
+            json_object_put(commands);
+            return NULL;
+        }
+    }
+    return commands;
 }
 
-void ipc_event_window() {
-    ipc_send_event("", IPC_EVENT_WINDOW);
+static void handle_ipc_command_list(struct ipc_client *client,
+        json_object *commands, enum ipc_command_type payload_type) {
+    size_t count = json_object_array_length(commands);
+    char **cmds = calloc(count, sizeof(*cmds));
+    for (size_t i = 0; i < count; i++) {
+        json_object *command = json_object_array_get_idx(commands, i);
+        cmds[i] = (char *)json_object_get_string(command);
+    }
+
+    struct cmd_results **results = execute_commands(cmds, count);
+    char *json = cmd_results_list_to_json(results, count);
+    ipc_send_reply(client, payload_type, json, (uint32_t)strlen(json));
+
+    free(json);
+    for (size_t i = 0; i < count; i++) {
+        free_cmd_results(results[i]);
+    }
+    free(results);
+    free(cmds);
 }
 
 void handle_ipc_command(struct ipc_client *client,
         char *buf, uint32_t payload_length,
         enum ipc_command_type payload_type) {
+    json_object *commands = parse_command_list(buf);
+    if (commands) {
+        handle_ipc_command_list(client, commands, payload_type);
+        json_object_put(commands);
+        return;
+    }
+
     // Logic for IPC_COMMAND
     char *line = strtok(buf, "\n");
     while (line) {
@@ -290,25 +590,172 @@ void handle_ipc_command(struct ipc_client *client,
     }
 
     struct cmd_results *results = execute_command(buf, NULL, NULL);
-    /* transaction_commit_dirty(); */
     char *json = cmd_results_to_json(results);
     int length = strlen(json);
     ipc_send_reply(client, payload_type, json, (uint32_t)length);
     free(json);
-    free(results);
+    free_cmd_results(results);
     return;
 }
 
 void handle_ipc_get_tags(struct ipc_client *client, char *buf,
         enum ipc_command_type payload_type) {
-    json_object *array;
+    send_snapshot(client, payload_type, IPC_SNAPSHOT_TAGS);
+}
+
+static const struct {
+    const char *name;
+    enum ipc_command_type event;
+} ipc_event_names[] = {
+    {"workspace", IPC_EVENT_TAG},
+    {"barconfig_update", IPC_EVENT_BARCONFIG_UPDATE},
+    {"mode", IPC_EVENT_MODE},
+    {"shutdown", IPC_EVENT_SHUTDOWN},
+    {"window", IPC_EVENT_WINDOW},
+    {"output", IPC_EVENT_OUTPUT},
+    {"binding", IPC_EVENT_BINDING},
+    {"tick", IPC_EVENT_TICK},
+};
+
+// returns false if name isn't an event
+static bool get_event_by_name(const char *name, enum ipc_command_type *event) {
+    for (int i = 0; name && i < LENGTH(ipc_event_names); i++) {
+        if (strcmp(ipc_event_names[i].name, name) == 0) {
+            *event = ipc_event_names[i].event;
+            return true;
+        }
+    }
+    return false;
+}
 
-    array = ipc_json_describe_tagsets();
+static char **parse_filter_changes(json_object *value) {
+    if (json_object_is_type(value, json_type_string)) {
+        char **changes = g_new0(char *, 2);
+        changes[0] = g_strdup(json_object_get_string(value));
+        return changes;
+    }
+    if (!json_object_is_type(value, json_type_array)) {
+        return NULL;
+    }
 
-    const char *json_string = json_object_get_string(array);
-    ipc_send_reply(client, payload_type, json_string,
-            strlen(json_string));
-    json_object_put(array); // free
+    size_t len = json_object_array_length(value);
+    char **changes = g_new0(char *, len + 1);
+    for (size_t i = 0; i < len; i++) {
+        json_object *change = json_object_array_get_idx(value, i);
+        if (!json_object_is_type(change, json_type_string)) {
+            g_strfreev(changes);
+            return NULL;
+        }
+        changes[i] = g_strdup(json_object_get_string(change));
+    }
+    return changes;
+}
+
+/* parses a subscription like {"event": "window", "output": "DP-1",
+ * "tag": 2, "app_id": "foot", "change": ["focus", "title"]}, returns NULL if
+ * it is invalid */
+static struct ipc_filter *parse_filter(json_object *object) {
+    json_object *value;
+    enum ipc_command_type event;
+    if (!json_object_object_get_ex(object, "event", &value)
+            || !get_event_by_name(json_object_get_string(value), &event)) {
+        return NULL;
+    }
+
+    struct ipc_filter *filter = create_ipc_filter(event);
+    json_object_object_foreach(object, key, val) {
+        bool valid = true;
+        if (strcmp(key, "event") == 0) {
+            continue;
+        } else if (strcmp(key, "output") == 0) {
+            valid = json_object_is_type(val, json_type_string);
+            if (valid) {
+                filter->output = strdup(json_object_get_string(val));
+            }
+        } else if (strcmp(key, "app_id") == 0) {
+            valid = json_object_is_type(val, json_type_string);
+            if (valid) {
+                filter->app_id = strdup(json_object_get_string(val));
+            }
+        } else if (strcmp(key, "tag") == 0) {
+            valid = json_object_is_type(val, json_type_int)
+                && json_object_get_int64(val) >= 0;
+            if (valid) {
+                filter->tag_id = json_object_get_int64(val);
+            }
+        } else if (strcmp(key, "change") == 0) {
+            filter->changes = parse_filter_changes(val);
+            valid = filter->changes != NULL;
+        } else {
+            valid = false;
+        }
+
+        if (!valid) {
+            destroy_ipc_filter(filter);
+            return NULL;
+        }
+    }
+    return filter;
+}
+
+/* the request is applied as a whole, so nothing changes if any of its
+ * subscriptions is invalid */
+static bool subscribe(struct ipc_client *client, json_object *request,
+        bool *is_tick) {
+    if (!json_object_is_type(request, json_type_array)) {
+        return false;
+    }
+
+    uint32_t events = 0;
+    bool delta_events = false;
+    GPtrArray *filters = g_ptr_array_new_with_free_func(destroy_ipc_filter);
+    for (size_t i = 0; i < json_object_array_length(request); i++) {
+        json_object *item = json_object_array_get_idx(request, i);
+        if (json_object_is_type(item, json_type_object)) {
+            struct ipc_filter *filter = parse_filter(item);
+            if (!filter) {
+                g_ptr_array_unref(filters);
+                return false;
+            }
+            g_ptr_array_add(filters, filter);
+            continue;
+        }
+        if (!json_object_is_type(item, json_type_string)) {
+            g_ptr_array_unref(filters);
+            return false;
+        }
+
+        const char *name = json_object_get_string(item);
+        enum ipc_command_type event;
+        if (strcmp(name, "delta") == 0) {
+            delta_events = true;
+        } else if (get_event_by_name(name, &event)) {
+            events |= CREATE_EVENT_BITMASK(event);
+        } else {
+            g_ptr_array_unref(filters);
+            return false;
+        }
+    }
+
+    client->subscribed_events |= events;
+    for (int i = 0; i < filters->len; i++) {
+        struct ipc_filter *filter = g_ptr_array_index(filters, i);
+        ipc_client_add_filter(client, filter);
+        if (filter->event == IPC_EVENT_TICK) {
+            *is_tick = true;
+        }
+    }
+    // the filters belong to the client now
+    g_ptr_array_set_free_func(filters, NULL);
+    g_ptr_array_unref(filters);
+
+    if (delta_events) {
+        // the first delta of every object has to be complete
+        client->delta_events = true;
+        reset_delta_states();
+    }
+    *is_tick = *is_tick || (events & CREATE_EVENT_BITMASK(IPC_EVENT_TICK));
+    return true;
 }
 
 void handle_ipc_subscribe(struct ipc_client *client, char *buf, enum ipc_command_type payload_type) {
@@ -318,35 +765,21 @@ void handle_ipc_subscribe(struct ipc_client *client, char *buf, enum ipc_command
     struct json_object *request = json_tokener_parse(buf);
 
     bool is_tick = false;
-    // parse requested event types
-    for (size_t i = 0; i < json_object_array_length(request); i++) {
-        const char *event_type = json_object_get_string(json_object_array_get_idx(request, i));
-        if (strcmp(event_type, "workspace") == 0) {
-            client->subscribed_events |= CREATE_EVENT_BITMASK(IPC_EVENT_TAG);
-        } else if (strcmp(event_type, "barconfig_update") == 0) {
-            client->subscribed_events |= CREATE_EVENT_BITMASK(IPC_EVENT_BARCONFIG_UPDATE);
-        } else if (strcmp(event_type, "mode") == 0) {
-            client->subscribed_events |= CREATE_EVENT_BITMASK(IPC_EVENT_MODE);
-        } else if (strcmp(event_type, "shutdown") == 0) {
-            client->subscribed_events |= CREATE_EVENT_BITMASK(IPC_EVENT_SHUTDOWN);
-        } else if (strcmp(event_type, "window") == 0) {
-            client->subscribed_events |= CREATE_EVENT_BITMASK(IPC_EVENT_WINDOW);
-        } else if (strcmp(event_type, "binding") == 0) {
-            client->subscribed_events |= CREATE_EVENT_BITMASK(IPC_EVENT_BINDING);
-        } else if (strcmp(event_type, "tick") == 0) {
-            client->subscribed_events |= CREATE_EVENT_BITMASK(IPC_EVENT_TICK);
-            is_tick = true;
-        } else {
-            const char msg[] = "{\"success\": false}";
-            ipc_send_reply(client, payload_type, msg, strlen(msg));
-            json_object_put(request);
-            printf("Unsupported event type in subscribe request\n");
-        }
+    bool success = subscribe(client, request, &is_tick);
+    json_object_put(request);
+
+    if (!success) {
+        printf("Unsupported event type in subscribe request\n");
+        const char msg[] = "{\"success\": false}";
+        ipc_send_reply(client, payload_type, msg, strlen(msg));
+        return;
     }
 
-    json_object_put(request);
     const char msg[] = "{\"success\": true}";
-    ipc_send_reply(client, payload_type, msg, strlen(msg));
+    // the client is gone if the reply couldn't be queued
+    if (!ipc_send_reply(client, payload_type, msg, strlen(msg))) {
+        return;
+    }
     if (is_tick) {
         const char tickmsg[] = "{\"first\": true, \"payload\": \"\"}";
         ipc_send_reply(client, IPC_EVENT_TICK, tickmsg,
@@ -356,12 +789,7 @@ void handle_ipc_subscribe(struct ipc_client *client, char *buf, enum ipc_command
 
 void handle_ipc_get_tree(struct ipc_client *client, char *buf,
         enum ipc_command_type payload_type) {
-    struct monitor *m = server_get_selected_monitor();
-    json_object *tree = ipc_json_describe_selected_container(m);
-    const char *json_string = json_object_to_json_string(tree);
-
-    ipc_send_reply(client, payload_type, json_string, strlen(json_string));
-    json_object_put(tree);
+    send_snapshot(client, payload_type, IPC_SNAPSHOT_TREE);
 }
 
 void handle_ipc_get_bar_config(struct ipc_client *client, char *buf, enum ipc_command_type payload_type) {
@@ -386,9 +814,207 @@ void handle_ipc_get_bar_config(struct ipc_client *client, char *buf, enum ipc_co
     }
 }
 
+void handle_ipc_get_stats(struct ipc_client *client, char *buf,
+        enum ipc_command_type payload_type) {
+    struct ipc_payload payload;
+    ipc_payload_init(&payload, ipc_json_describe_stats(), JSON_C_TO_STRING_SPACED);
+    ipc_send_payload(client, payload_type, &payload);
+    ipc_payload_finish(&payload);
+}
+
+static struct monitor *get_monitor_by_name(const char *name) {
+    if (strcmp(name, "focused") == 0) {
+        return server_get_selected_monitor();
+    }
+    for (int i = 0; i < server.mons->len; i++) {
+        struct monitor *m = g_ptr_array_index(server.mons, i);
+        if (strcmp(m->wlr_output->name, name) == 0) {
+            return m;
+        }
+    }
+    return NULL;
+}
+
+// unlike get_tag this doesn't create missing tags
+static struct tag *get_tag_by_selector(const char *selector) {
+    char *end;
+    errno = 0;
+    long id = strtol(selector, &end, 10);
+    if (errno != 0 || end == selector || *end != '\0' || id < 0 || id > INT_MAX) {
+        return NULL;
+    }
+    int key = id;
+    return g_hash_table_lookup(server.tags, &key);
+}
+
+static json_object *describe_focused_window(struct container *con) {
+    return con ? describe_window(con) : NULL;
+}
+
+/* unlike describe_tag this also describes tags without a monitor, their
+ * monitor fields are null */
+static json_object *describe_tag_slice(struct tag *tag) {
+    struct monitor *m = get_tag_event_monitor(tag);
+    json_object *object = ipc_json_describe_tag(tag->name, tag_is_active(tag), m);
+    json_object_object_add(object, "id", json_object_new_int64(tag->id));
+    json_object_object_add(object, "visible",
+            json_object_new_boolean(m && tag_is_visible(tag, m)));
+    json_object_object_add(object, "layout", tag->current_layout
+            ? json_object_new_string(tag->current_layout) : NULL);
+    json_object_object_add(object, "window_count",
+            json_object_new_int(tag->con_set->tiled_containers->len));
+    return object;
+}
+
+static json_object *describe_tag_windows(struct tag *tag) {
+    json_object *array = json_object_new_array();
+    GPtrArray *containers = tag->con_set->tiled_containers;
+    for (int i = 0; i < containers->len; i++) {
+        struct container *con = g_ptr_array_index(containers, i);
+        json_object_array_add(array, describe_window(con));
+    }
+    return array;
+}
+
+static json_object *describe_monitor_slice(struct monitor *m) {
+    json_object *object = ipc_json_describe_monitor(m);
+    struct tag *tag = monitor_get_active_tag(m);
+    json_object_object_add(object, "tag",
+            tag ? json_object_new_int64(tag->id) : NULL);
+    json_object_object_add(object, "layout", tag && tag->current_layout
+            ? json_object_new_string(tag->current_layout) : NULL);
+    return object;
+}
+
+/* describes the slice of the state that the first parts of path select and
+ * advances path past them. Only the selected objects are described. */
+static bool describe_slice(char ***path, json_object **slice,
+        const char **error) {
+    char **part = *path;
+    *slice = NULL;
+    if (strcmp(part[0], "focused") == 0) {
+        struct monitor *m = server_get_selected_monitor();
+        *slice = describe_focused_window(m ? monitor_get_focused_container(m) : NULL);
+        *path = part + 1;
+        return true;
+    }
+
+    if (strcmp(part[0], "tag") == 0) {
+        struct tag *tag = part[1] ? get_tag_by_selector(part[1]) : NULL;
+        if (!tag) {
+            *error = "no such tag";
+            return false;
+        }
+
+        if (part[2] && strcmp(part[2], "windows") == 0) {
+            *slice = describe_tag_windows(tag);
+            *path = part + 3;
+        } else if (part[2] && strcmp(part[2], "focused") == 0) {
+            *slice = describe_focused_window(tag_get_focused_container(tag));
+            *path = part + 3;
+        } else {
+            *slice = describe_tag_slice(tag);
+            *path = part + 2;
+        }
+        return true;
+    }
+
+    if (strcmp(part[0], "monitor") == 0) {
+        struct monitor *m = part[1] ? get_monitor_by_name(part[1]) : NULL;
+        if (!m) {
+            *error = "no such monitor";
+            return false;
+        }
+        *slice = describe_monitor_slice(m);
+        *path = part + 2;
+        return true;
+    }
+
+    *error = "unknown selector";
+    return false;
+}
+
+// returns a new reference to the field of object that path points to
+static bool select_field(json_object *object, char **path,
+        json_object **field) {
+    for (char **part = path; *part; part++) {
+        json_object *next = NULL;
+        if (json_object_is_type(object, json_type_object)) {
+            if (!json_object_object_get_ex(object, *part, &next)) {
+                return false;
+            }
+        } else if (json_object_is_type(object, json_type_array)) {
+            char *end;
+            long i = strtol(*part, &end, 10);
+            if (end == *part || *end != '\0'
+                    || i < 0 || i >= json_object_array_length(object)) {
+                return false;
+            }
+            next = json_object_array_get_idx(object, i);
+        } else {
+            return false;
+        }
+        object = next;
+    }
+    *field = json_object_get(object);
+    return true;
+}
+
+json_object *ipc_query(const char *selector) {
+    char **path = g_strsplit(selector, "/", 0);
+    char **rest = path;
+    json_object *slice = NULL;
+    json_object *result = NULL;
+    const char *error = NULL;
+
+    if (!path[0] || !path[0][0]) {
+        error = "empty selector";
+    } else if (describe_slice(&rest, &slice, &error)
+            && !select_field(slice, rest, &result)) {
+        error = "no such field";
+    }
+    json_object_put(slice);
+    g_strfreev(path);
+
+    json_object *reply = json_object_new_object();
+    json_object_object_add(reply, "success", json_object_new_boolean(!error));
+    if (error) {
+        json_object_object_add(reply, "error", json_object_new_string(error));
+    } else {
+        json_object_object_add(reply, "result", result);
+    }
+    return reply;
+}
+
+void handle_ipc_query(struct ipc_client *client, char *buf,
+        enum ipc_command_type payload_type) {
+    struct ipc_payload payload;
+    ipc_payload_init(&payload, ipc_query(buf), JSON_C_TO_STRING_PLAIN);
+    ipc_send_payload(client, payload_type, &payload);
+    ipc_payload_finish(&payload);
+}
+
+/* the reply is always json, so clients can read it before they switch to the
+ * new encoding */
+void handle_ipc_set_encoding(struct ipc_client *client, char *buf,
+        enum ipc_command_type payload_type) {
+    enum ipc_encoding previous = client->encoding;
+    int encoding = ipc_encoding_from_string(buf);
+    const char *msg = encoding < 0
+        ? "{\"success\": false, \"error\": \"unknown encoding\"}"
+        : "{\"success\": true}";
+
+    client->encoding = IPC_ENCODING_JSON;
+    // sending may disconnect the client
+    if (!ipc_send_reply(client, payload_type, msg, strlen(msg))) {
+        return;
+    }
+    client->encoding = encoding < 0 ? previous : encoding;
+}
+
 // Function to receive payload
 static char* receive_payload(struct ipc_client *client, uint32_t payload_length) {
-    if (client == NULL || payload_length == 0) {
+    if (client == NULL) {
         return NULL;
     }
 
@@ -398,8 +1024,13 @@ static char* receive_payload(struct ipc_client *client, uint32_t payload_length)
         return NULL;
     }
 
+    if (payload_length == 0) {
+        buf[0] = '\0';
+        return buf;
+    }
+
     ssize_t received = recv(client->fd, buf, payload_length, 0);
-    if (received == -1) {
+    if (received != payload_length) {
         printf("Unable to receive payload from IPC client\n");
         free(buf);
         return NULL;
@@ -433,6 +1064,17 @@ static void dispatch_ipc_command(struct ipc_client *client, char *buf,
         case IPC_GET_BAR_CONFIG:
             handle_ipc_get_bar_config(client, buf, payload_type);
             break;
+        case IPC_GET_STATS:
+            handle_ipc_get_stats(client, buf, payload_type);
+            break;
+        case IPC_SET_ENCODING:
+            handle_ipc_set_encoding(client, buf, payload_type);
+            break;
+
+        case IPC_QUERY:
+            handle_ipc_query(client, buf, payload_type);
+            break;
+
         default:
             printf("Unknown IPC command type %x\n", payload_type);
             break;
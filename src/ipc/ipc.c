@@ -9,21 +9,35 @@
 #include <string.h>
 #include <sys/socket.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 #include <sys/un.h>
+#include <errno.h>
 #include <unistd.h>
 #include <wayland-server-core.h>
 #include <wlr/util/log.h>
 
 #include "ipc/ipc.h"
 #include "ipc/ipc-server.h"
+#include "msgpack.h"
+#include "utils/coreUtils.h"
 
 static struct sockaddr_un *ipc_sockaddr = NULL;
 static GPtrArray *ipc_client_list;
 
+static size_t queue_limit = 4e6; // 4 MB
+// the most messages that are written to a client with a single writev
+#define MAX_WRITE_MESSAGES 64
+static enum ipc_overflow_policy overflow_policy = IPC_OVERFLOW_DROP_OLDEST;
+
 static int read_client_header(int client_fd, struct ipc_client *client);
-static void ipc_client_disconnect(struct ipc_client *client);
+
+// events may be raised before ipc_init, e.g. in tests
+static size_t get_client_count() {
+    return ipc_client_list ? ipc_client_list->len : 0;
+}
 static int check_socket_errors(uint32_t mask, struct ipc_client *client);
 static int get_available_read_data(int client_fd, struct ipc_client *client);
+static void destroy_ipc_message(void *data);
 
 struct sockaddr_un *ipc_user_sockaddr(void);
 
@@ -34,6 +48,7 @@ void ipc_init(struct wl_event_loop *wl_event_loop) {
     if (ipc_socket == -1) {
         printf("Unable to create IPC socket\n");
     }
+    server.ipc_socket = ipc_socket;
     if (fcntl(ipc_socket, F_SETFD, FD_CLOEXEC) == -1) {
         printf("Unable to set CLOEXEC on IPC socket\n");
     }
@@ -65,9 +80,7 @@ void ipc_init(struct wl_event_loop *wl_event_loop) {
 
 int ipc_handle_connection(int fd, uint32_t mask, void *data) {
     struct wl_event_loop *wl_event_loop = data;
-    (void) fd;
-    int ipc_socket = server.ipc_socket;
-    int client_fd = accept(ipc_socket, NULL, NULL);
+    int client_fd = accept(fd, NULL, NULL);
     if (client_fd == -1) {
         printf("Unable to accept IPC client connection\n");
         return 0;
@@ -93,18 +106,19 @@ int ipc_handle_connection(int fd, uint32_t mask, void *data) {
     client->pending_length = 0;
     client->fd = client_fd;
     client->subscribed_events = 0;
+    client->filtered_events = 0;
+    client->filters = g_ptr_array_new_with_free_func(destroy_ipc_filter);
+    client->stale_objects = g_hash_table_new_full(
+            g_int64_hash, g_int64_equal, g_free, NULL);
+    client->delta_events = false;
+    client->encoding = IPC_ENCODING_JSON;
     client->event_source = wl_event_loop_add_fd(wl_event_loop,
             client_fd, WL_EVENT_READABLE, ipc_client_handle_readable, client);
     client->writable_event_source = NULL;
 
-    client->write_buffer_size = 128;
-    client->write_buffer_len = 0;
-    client->write_buffer = malloc(client->write_buffer_size);
-    if (!client->write_buffer) {
-        printf("Unable to allocate ipc client write buffer\n");
-        close(client_fd);
-        return 0;
-    }
+    client->write_queue = g_queue_new();
+    client->queued_bytes = 0;
+    client->stats = (struct ipc_client_stats){0};
 
     g_ptr_array_add(ipc_client_list, client);
     return 0;
@@ -134,7 +148,7 @@ struct sockaddr_un *ipc_user_sockaddr(void) {
     return ipc_sockaddr;
 }
 
-static void ipc_client_disconnect(struct ipc_client *client) {
+void ipc_client_disconnect(struct ipc_client *client) {
     if (!(client != NULL)) {
         return;
     }
@@ -151,45 +165,100 @@ static void ipc_client_disconnect(struct ipc_client *client) {
         i++;
     }
     g_ptr_array_remove_index(ipc_client_list, i);
-    free(client->write_buffer);
+    g_queue_free_full(client->write_queue, destroy_ipc_message);
+    g_ptr_array_unref(client->filters);
+    g_hash_table_destroy(client->stale_objects);
     close(client->fd);
     free(client);
 }
 
-bool ipc_send_reply(struct ipc_client *client, enum ipc_command_type payload_type,
-        const char *payload, uint32_t payload_length) {
-    assert(payload);
+static void destroy_ipc_message(void *data) {
+    struct ipc_message *message = data;
+    free(message->coalesce_key);
+    g_byte_array_unref(message->payload);
+    free(message);
+}
 
-    char data[IPC_HEADER_SIZE];
+// takes a new reference to payload instead of copying it
+static struct ipc_message *create_ipc_message(enum ipc_command_type payload_type,
+        GByteArray *payload) {
+    struct ipc_message *message = calloc(1, sizeof(*message));
+    uint32_t payload_length = payload->len;
+    message->payload = g_byte_array_ref(payload);
+    message->len = IPC_HEADER_SIZE + payload_length;
+
+    char *header = message->header;
+    memcpy(header, ipc_magic, sizeof(ipc_magic));
+    memcpy(header + sizeof(ipc_magic), &payload_length, sizeof(payload_length));
+    memcpy(header + sizeof(ipc_magic) + sizeof(payload_length), &payload_type, sizeof(payload_type));
+    return message;
+}
 
-    memcpy(data, ipc_magic, sizeof(ipc_magic));
-    memcpy(data + sizeof(ipc_magic), &payload_length, sizeof(payload_length));
-    memcpy(data + sizeof(ipc_magic) + sizeof(payload_length), &payload_type, sizeof(payload_type));
+// messages that were partially written can't be removed anymore
+static bool is_removable(struct ipc_message *message) {
+    return message->is_event && message->offset == 0;
+}
 
-    while (client->write_buffer_len + IPC_HEADER_SIZE + payload_length >=
-                 client->write_buffer_size) {
-        client->write_buffer_size *= 2;
+static void remove_queued_message(struct ipc_client *client, GList *link) {
+    struct ipc_message *message = link->data;
+    client->queued_bytes -= message->len;
+    g_queue_delete_link(client->write_queue, link);
+    destroy_ipc_message(message);
+}
+
+static void coalesce_event(struct ipc_client *client, const char *coalesce_key) {
+    for (GList *link = client->write_queue->head; link; link = link->next) {
+        struct ipc_message *message = link->data;
+        if (!is_removable(message) || !message->coalesce_key) {
+            continue;
+        }
+        if (strcmp(message->coalesce_key, coalesce_key) == 0) {
+            remove_queued_message(client, link);
+            client->stats.coalesced_events++;
+            server.stats.ipc.coalesced_events++;
+            return;
+        }
     }
+}
 
-    if (client->write_buffer_size > 4e6) { // 4 MB
-        printf("Client write buffer too big (%zu), disconnecting client\n",
-                client->write_buffer_size);
-        ipc_client_disconnect(client);
-        return false;
+// returns false if the client was disconnected
+static bool enforce_queue_limit(struct ipc_client *client) {
+    GList *link = client->write_queue->head;
+    while (client->queued_bytes > queue_limit
+            && overflow_policy == IPC_OVERFLOW_DROP_OLDEST && link) {
+        GList *next = link->next;
+        if (is_removable(link->data)) {
+            remove_queued_message(client, link);
+            client->stats.dropped_events++;
+            server.stats.ipc.dropped_events++;
+        }
+        link = next;
     }
 
-    char *new_buffer = realloc(client->write_buffer, client->write_buffer_size);
-    if (!new_buffer) {
-        printf("Unable to reallocate ipc client write buffer\n");
+    if (client->queued_bytes > queue_limit) {
+        printf("Client %d has %zu queued bytes, disconnecting client\n",
+                client->fd, client->queued_bytes);
+        server.stats.ipc.overflow_disconnects++;
         ipc_client_disconnect(client);
         return false;
     }
-    client->write_buffer = new_buffer;
+    return true;
+}
+
+static bool queue_message(struct ipc_client *client, struct ipc_message *message) {
+    if (message->coalesce_key) {
+        coalesce_event(client, message->coalesce_key);
+    }
 
-    memcpy(client->write_buffer + client->write_buffer_len, data, IPC_HEADER_SIZE);
-    client->write_buffer_len += IPC_HEADER_SIZE;
-    memcpy(client->write_buffer + client->write_buffer_len, payload, payload_length);
-    client->write_buffer_len += payload_length;
+    g_queue_push_tail(client->write_queue, message);
+    client->queued_bytes += message->len;
+
+    if (!enforce_queue_limit(client)) {
+        return false;
+    }
+    if (client->queued_bytes > client->stats.max_queued_bytes) {
+        client->stats.max_queued_bytes = client->queued_bytes;
+    }
 
     if (!client->writable_event_source) {
         client->writable_event_source = wl_event_loop_add_fd(
@@ -200,6 +269,51 @@ bool ipc_send_reply(struct ipc_client *client, enum ipc_command_type payload_typ
     return true;
 }
 
+static bool send_encoded(struct ipc_client *client,
+        enum ipc_command_type payload_type, struct ipc_payload *payload,
+        bool is_event, const char *coalesce_key) {
+    GByteArray *encoded = ipc_payload_get(payload, client->encoding);
+    struct ipc_message *message = create_ipc_message(payload_type, encoded);
+    message->is_event = is_event;
+    // deltas depend on the previous events, so none of them is superseded
+    if (coalesce_key && !client->delta_events) {
+        message->coalesce_key = strdup(coalesce_key);
+    }
+    return queue_message(client, message);
+}
+
+bool ipc_send_reply(struct ipc_client *client, enum ipc_command_type payload_type,
+        const char *payload, uint32_t payload_length) {
+    assert(payload);
+
+    if (client->encoding == IPC_ENCODING_JSON) {
+        GByteArray *data = g_byte_array_sized_new(payload_length);
+        g_byte_array_append(data, (const guint8 *)payload, payload_length);
+        struct ipc_message *message = create_ipc_message(payload_type, data);
+        g_byte_array_unref(data);
+        return queue_message(client, message);
+    }
+
+    json_tokener *tokener = json_tokener_new();
+    json_object *object = json_tokener_parse_ex(tokener, payload, payload_length);
+    json_tokener_free(tokener);
+    if (!object) {
+        // not json, send it as a string
+        object = json_object_new_string_len(payload, payload_length);
+    }
+
+    struct ipc_payload reply;
+    ipc_payload_init(&reply, object, JSON_C_TO_STRING_PLAIN);
+    bool sent = send_encoded(client, payload_type, &reply, false, NULL);
+    ipc_payload_finish(&reply);
+    return sent;
+}
+
+bool ipc_send_payload(struct ipc_client *client,
+        enum ipc_command_type payload_type, struct ipc_payload *payload) {
+    return send_encoded(client, payload_type, payload, false, NULL);
+}
+
 static int check_socket_errors(uint32_t mask, struct ipc_client *client) {
     if (mask & (WL_EVENT_ERROR | WL_EVENT_HANGUP)) {
         printf("Client %d disconnected%s\n", client->fd, 
@@ -217,26 +331,264 @@ int ipc_client_handle_readable(int client_fd, uint32_t mask, void *data) {
         return 0;
     }
 
-    if (get_available_read_data(client_fd, client)) {
+    int read_available = get_available_read_data(client_fd, client);
+    if (read_available == -1) {
+        return 0;
+    }
+
+    // Wait until the whole payload is available before handling it
+    if (client->pending_length > 0) {
+        if ((uint32_t)read_available >= client->pending_length) {
+            handle_client_payload(client);
+        }
         return 0;
     }
 
-    return (client->pending_length > 0) ? 
-            handle_client_payload(client) : 
-            read_client_header(client_fd, client);
+    if (read_available < (int)IPC_HEADER_SIZE) {
+        return 0;
+    }
+
+    if (read_client_header(client_fd, client)) {
+        return 0;
+    }
+
+    // The payload usually arrives together with the header. Messages without
+    // a payload like IPC_GET_TAGS have to be handled right away since no
+    // further data will make the socket readable again.
+    read_available -= IPC_HEADER_SIZE;
+    if ((uint32_t)read_available >= client->pending_length) {
+        handle_client_payload(client);
+    }
+    return 0;
+}
+
+void ipc_send_event(struct ipc_payload *payload, enum ipc_command_type event,
+        struct ipc_event_info *info) {
+    ipc_send_event_payloads(payload, payload, event, info, NULL);
+}
+
+struct ipc_filter *create_ipc_filter(enum ipc_command_type event) {
+    struct ipc_filter *filter = calloc(1, sizeof(*filter));
+    filter->event = event;
+    filter->tag_id = -1;
+    return filter;
+}
+
+void destroy_ipc_filter(void *data) {
+    struct ipc_filter *filter = data;
+    free(filter->output);
+    free(filter->app_id);
+    g_strfreev(filter->changes);
+    free(filter);
+}
+
+void ipc_client_add_filter(struct ipc_client *client, struct ipc_filter *filter) {
+    client->filtered_events |= CREATE_EVENT_BITMASK(filter->event);
+    g_ptr_array_add(client->filters, filter);
+}
+
+static bool lenient_str_equal(const char *pattern, const char *str) {
+    return !pattern || (str && strcmp(pattern, str) == 0);
+}
+
+static bool filter_matches(struct ipc_filter *filter,
+        enum ipc_command_type event, struct ipc_event_info *info) {
+    if (filter->event != event) {
+        return false;
+    }
+    if (filter->tag_id >= 0 && filter->tag_id != info->tag_id) {
+        return false;
+    }
+    if (filter->changes && !(info->change
+                && g_strv_contains((const char * const *)filter->changes, info->change))) {
+        return false;
+    }
+    return lenient_str_equal(filter->output, info->output)
+        && lenient_str_equal(filter->app_id, info->app_id);
+}
+
+static bool client_wants_event(struct ipc_client *client,
+        enum ipc_command_type event, struct ipc_event_info *info) {
+    uint32_t event_bit = CREATE_EVENT_BITMASK(event);
+    if (client->subscribed_events & event_bit) {
+        return true;
+    }
+    if (!(client->filtered_events & event_bit) || !info) {
+        return false;
+    }
+
+    for (int i = 0; i < client->filters->len; i++) {
+        if (filter_matches(g_ptr_array_index(client->filters, i), event, info)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int64_t get_object_key(enum ipc_command_type event, int64_t id) {
+    return ((int64_t)(event & 0x7F) << 32) | (id & 0xFFFFFFFF);
+}
+
+// remembers that the client didn't receive the changes of the event
+static void mark_objects_stale(struct ipc_client *client,
+        enum ipc_command_type event, struct ipc_event_info *info) {
+    for (int i = 0; info && i < LENGTH(info->object_ids); i++) {
+        if (info->object_ids[i] < 0) {
+            continue;
+        }
+        int64_t *key = g_new(int64_t, 1);
+        *key = get_object_key(event, info->object_ids[i]);
+        g_hash_table_add(client->stale_objects, key);
+    }
+}
+
+static bool has_stale_objects(struct ipc_client *client,
+        enum ipc_command_type event, struct ipc_event_info *info) {
+    for (int i = 0; info && i < LENGTH(info->object_ids); i++) {
+        int64_t key = get_object_key(event, info->object_ids[i]);
+        if (info->object_ids[i] >= 0
+                && g_hash_table_contains(client->stale_objects, &key)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void clear_stale_objects(struct ipc_client *client,
+        enum ipc_command_type event, struct ipc_event_info *info) {
+    for (int i = 0; info && i < LENGTH(info->object_ids); i++) {
+        int64_t key = get_object_key(event, info->object_ids[i]);
+        g_hash_table_remove(client->stale_objects, &key);
+    }
 }
 
-void ipc_send_event(const char *json_string, enum ipc_command_type event) {
+void ipc_forget_object(enum ipc_command_type event, int64_t id) {
+    int64_t key = get_object_key(event, id);
+    for (size_t i = 0; i < get_client_count(); i++) {
+        struct ipc_client *client = g_ptr_array_index(ipc_client_list, i);
+        g_hash_table_remove(client->stale_objects, &key);
+    }
+}
+
+bool ipc_has_subscribers(enum ipc_command_type event, bool delta_events,
+        struct ipc_event_info *info) {
+    for (size_t i = 0; i < get_client_count(); i++) {
+        struct ipc_client *client = g_ptr_array_index(ipc_client_list, i);
+        if (!client_wants_event(client, event, info)) {
+            continue;
+        }
+        if (client->delta_events == delta_events) {
+            return true;
+        }
+        // delta subscribers get the complete payload after skipped changes
+        if (!delta_events && has_stale_objects(client, event, info)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+GPtrArray *ipc_get_clients() {
+    return ipc_client_list;
+}
+
+void ipc_set_queue_limit(size_t limit) {
+    queue_limit = limit;
+}
+
+size_t ipc_get_queue_limit() {
+    return queue_limit;
+}
+
+void ipc_set_overflow_policy(enum ipc_overflow_policy policy) {
+    overflow_policy = policy;
+}
+
+enum ipc_overflow_policy ipc_get_overflow_policy() {
+    return overflow_policy;
+}
+
+void ipc_payload_init(struct ipc_payload *payload, json_object *object,
+        int json_flags) {
+    *payload = (struct ipc_payload){
+        .object = object,
+        .json_flags = json_flags,
+    };
+}
+
+void ipc_payload_finish(struct ipc_payload *payload) {
+    for (int i = 0; i < IPC_ENCODING_COUNT; i++) {
+        if (payload->encoded[i]) {
+            g_byte_array_unref(payload->encoded[i]);
+        }
+    }
+    json_object_put(payload->object);
+    *payload = (struct ipc_payload){0};
+}
+
+GByteArray *ipc_payload_get(struct ipc_payload *payload,
+        enum ipc_encoding encoding) {
+    if (payload->encoded[encoding]) {
+        return payload->encoded[encoding];
+    }
+
+    GByteArray *encoded = g_byte_array_new();
+    if (payload->object) {
+        switch (encoding) {
+            case IPC_ENCODING_MSGPACK:
+                msgpack_encode(encoded, payload->object);
+                break;
+            default:
+                {
+                    size_t length;
+                    const char *json_string = json_object_to_json_string_length(
+                            payload->object, payload->json_flags, &length);
+                    g_byte_array_append(encoded, (const guint8 *)json_string, length);
+                }
+                break;
+        }
+    }
+    server.stats.ipc.payload_encodes++;
+    payload->encoded[encoding] = encoded;
+    return encoded;
+}
+
+int ipc_encoding_from_string(const char *name) {
+    if (strcmp(name, "json") == 0) {
+        return IPC_ENCODING_JSON;
+    }
+    if (strcmp(name, "msgpack") == 0) {
+        return IPC_ENCODING_MSGPACK;
+    }
+    return -1;
+}
+
+void ipc_send_event_payloads(struct ipc_payload *payload,
+        struct ipc_payload *delta, enum ipc_command_type event,
+        struct ipc_event_info *info, const char *coalesce_key) {
     struct ipc_client *client;
-    for (size_t i = 0; i < ipc_client_list->len; i++) {
+    for (size_t i = 0; i < get_client_count(); i++) {
         client = g_ptr_array_index(ipc_client_list, i);
-        if ((client->subscribed_events & CREATE_EVENT_BITMASK(event)) == 0) {
+        if (!client_wants_event(client, event, info)) {
+            bool is_filtered = client->filtered_events & CREATE_EVENT_BITMASK(event);
+            if (is_filtered) {
+                server.stats.ipc.filtered_events++;
+            }
+            if (client->delta_events && is_filtered) {
+                mark_objects_stale(client, event, info);
+            }
             continue;
         }
-        if (!ipc_send_reply(client, event, json_string,
-                (uint32_t)strlen(json_string))) {
-            printf("Unable to send reply to IPC client\n");
-            /* ipc_send_reply destroys client on error, which also
+
+        struct ipc_payload *client_payload = payload;
+        if (client->delta_events && has_stale_objects(client, event, info)) {
+            clear_stale_objects(client, event, info);
+        } else if (client->delta_events) {
+            client_payload = delta;
+        }
+        if (!send_encoded(client, event, client_payload, true, coalesce_key)) {
+            printf("Unable to send event to IPC client\n");
+            /* the client is destroyed on error, which also
              * removes it from the list, so we need to process
              * current index again */
             i--;
@@ -244,6 +596,48 @@ void ipc_send_event(const char *json_string, enum ipc_command_type event) {
     }
 }
 
+// fills iov with the unwritten parts of the first messages of the queue
+static int get_write_iovecs(struct ipc_client *client, struct iovec *iov,
+        int max_messages) {
+    int iovcnt = 0;
+    int count = 0;
+    for (GList *link = client->write_queue->head;
+            link && count < max_messages; link = link->next, count++) {
+        struct ipc_message *message = link->data;
+        if (message->offset < IPC_HEADER_SIZE) {
+            iov[iovcnt++] = (struct iovec){
+                .iov_base = message->header + message->offset,
+                .iov_len = IPC_HEADER_SIZE - message->offset,
+            };
+        }
+        size_t payload_offset = message->offset > IPC_HEADER_SIZE
+            ? message->offset - IPC_HEADER_SIZE : 0;
+        if (payload_offset < message->payload->len) {
+            iov[iovcnt++] = (struct iovec){
+                .iov_base = message->payload->data + payload_offset,
+                .iov_len = message->payload->len - payload_offset,
+            };
+        }
+    }
+    return iovcnt;
+}
+
+/* removes the messages that were completely written, returns false if one
+ * was only written partially because the socket is full */
+static bool remove_written_messages(struct ipc_client *client, size_t written) {
+    struct ipc_message *message;
+    while ((message = g_queue_peek_head(client->write_queue))) {
+        size_t remaining = message->len - message->offset;
+        if (written < remaining) {
+            message->offset += written;
+            return written == 0;
+        }
+        written -= remaining;
+        remove_queued_message(client, client->write_queue->head);
+    }
+    return true;
+}
+
 int ipc_client_handle_writable(int client_fd, uint32_t mask, void *data) {
     struct ipc_client *client = data;
 
@@ -259,24 +653,26 @@ int ipc_client_handle_writable(int client_fd, uint32_t mask, void *data) {
         return 0;
     }
 
-    if (client->write_buffer_len <= 0) {
-        return 0;
-    }
+    while (!g_queue_is_empty(client->write_queue)) {
+        struct iovec iov[2 * MAX_WRITE_MESSAGES];
+        int iovcnt = get_write_iovecs(client, iov, MAX_WRITE_MESSAGES);
+        ssize_t written = writev(client->fd, iov, iovcnt);
+        server.stats.ipc.write_calls++;
 
-    ssize_t written = write(client->fd, client->write_buffer, client->write_buffer_len);
+        if (written == -1 && errno == EAGAIN) {
+            return 0;
+        } else if (written == -1) {
+            printf("Unable to send data from queue to IPC client\n");
+            ipc_client_disconnect(client);
+            return 0;
+        }
 
-    if (written == -1 && errno == EAGAIN) {
-        return 0;
-    } else if (written == -1) {
-        printf("Unable to send data from queue to IPC client\n");
-        ipc_client_disconnect(client);
-        return 0;
+        if (!remove_written_messages(client, written)) {
+            return 0;
+        }
     }
 
-    memmove(client->write_buffer, client->write_buffer + written, client->write_buffer_len - written);
-    client->write_buffer_len -= written;
-
-    if (client->write_buffer_len == 0 && client->writable_event_source) {
+    if (client->writable_event_source) {
         wl_event_source_remove(client->writable_event_source);
         client->writable_event_source = NULL;
     }
@@ -284,35 +680,37 @@ int ipc_client_handle_writable(int client_fd, uint32_t mask, void *data) {
     return 0;
 }
 
+// returns the number of bytes that can be read or -1 upon failure
 static int get_available_read_data(int client_fd, struct ipc_client *client) {
     int read_available;
     if (ioctl(client_fd, FIONREAD, &read_available) == -1) {
         printf("Unable to read IPC socket buffer size\n");
         ipc_client_disconnect(client);
-        return 1; // Return 1 to indicate an error occurred
+        return -1;
     }
-    return 0; // Return 0 to indicate success
+    return read_available;
 }
 
+// returns 0 upon success and 1 if the client was disconnected
 static int read_client_header(int client_fd, struct ipc_client *client) {
     uint8_t buf[IPC_HEADER_SIZE];
     ssize_t received = recv(client_fd, buf, IPC_HEADER_SIZE, 0);
-    if (received == -1) {
+    if (received != IPC_HEADER_SIZE) {
         printf("Unable to receive header from IPC client\n");
         ipc_client_disconnect(client);
-        return 0;
+        return 1;
     }
 
     // Validate the IPC header
     if (memcmp(buf, ipc_magic, sizeof(ipc_magic)) != 0) {
         printf("IPC header check failed\n");
         ipc_client_disconnect(client);
-        return 0;
+        return 1;
     }
 
     // Extract and store header information
     memcpy(&client->pending_length, buf + sizeof(ipc_magic), sizeof(uint32_t));
     memcpy(&client->pending_type, buf + sizeof(ipc_magic) + sizeof(uint32_t), sizeof(uint32_t));
 
-    return handle_client_payload(client);
+    return 0;
 }
@@ -323,11 +323,22 @@ struct keybinding *create_keybinding(const char *binding, int lua_func_ref)
     struct keybinding *keybinding = calloc(1, sizeof(*keybinding));
     keybinding->binding = strdup(binding);
     keybinding->lua_func_ref = lua_func_ref;
+    keybinding->ref_count = 1;
+    return keybinding;
+}
+
+struct keybinding *keybinding_ref(struct keybinding *keybinding)
+{
+    keybinding->ref_count++;
     return keybinding;
 }
 
 void destroy_keybinding(struct keybinding *keybinding)
 {
+    keybinding->ref_count--;
+    if (keybinding->ref_count > 0)
+        return;
+
     free(keybinding->binding);
     if (keybinding->lua_func_ref > 0) {
         luaL_unref(L, LUA_REGISTRYINDEX, keybinding->lua_func_ref);
@@ -377,11 +388,7 @@ static bool sym_is_modifier(const char *sym)
 
 void *copy_keybinding(const void *keybinding_ptr, void *user_data)
 {
-    const struct keybinding *keybinding = keybinding_ptr;
-    lua_rawgeti(L, LUA_REGISTRYINDEX, keybinding->lua_func_ref);
-    int ref = luaL_ref(L, LUA_REGISTRYINDEX);
-    struct keybinding *kb_dup = create_keybinding(keybinding->binding, ref);
-    return kb_dup;
+    return keybinding_ref((struct keybinding *)keybinding_ptr);
 }
 
 int cmp_keybinding_strings(const char *binding1, const char *binding2)
@@ -5,22 +5,27 @@
 #include <stdio.h>
 #include <lua.h>
 #include <assert.h>
+#include <sys/stat.h>
 
 #include "server.h"
 #include "utils/coreUtils.h"
 #include "utils/parseConfigUtils.h"
 #include "tag.h"
+#include "translationLayer.h"
+
+// maps the name of a layout to its template
+static GHashTable *layout_templates = NULL;
 
 struct layout *create_layout(lua_State *L)
 {
     struct layout *lt = calloc(1, sizeof(*lt));
     *lt = (struct layout) {
         .current_max_area = -1,
-        .name = "two_pane",
         .n_area = 1,
         .n_master = 1,
     };
-    lt->linked_layouts = g_ptr_array_new();
+    lt->name = strdup("two_pane");
+    lt->linked_layouts = g_ptr_array_new_with_free_func(free);
     lt->linked_loaded_layouts = g_ptr_array_new();
 
     lt->options = create_options();
@@ -43,8 +48,23 @@ struct layout *create_layout(lua_State *L)
     return lt;
 }
 
+static void unref_layout_ref(int ref)
+{
+    if (ref > 0) {
+        luaL_unref(L, LUA_REGISTRYINDEX, ref);
+    }
+}
+
 void destroy_layout(struct layout *lt)
 {
+    unref_layout_ref(lt->lua_resize_function_ref);
+    unref_layout_ref(lt->lua_layout_ref);
+    unref_layout_ref(lt->lua_layout_copy_data_ref);
+    unref_layout_ref(lt->lua_layout_original_copy_data_ref);
+    unref_layout_ref(lt->lua_master_layout_data_ref);
+    unref_layout_ref(lt->lua_resize_data_ref);
+
+    free((char *)lt->name);
     destroy_options(lt->options);
 
     g_ptr_array_unref(lt->linked_layouts);
@@ -53,6 +73,159 @@ void destroy_layout(struct layout *lt)
     free(lt);
 }
 
+static void load_layout_file(lua_State *L, struct layout *lt)
+{
+    init_local_config_variables(L, lt);
+    const char *name = lt->name;
+
+    char *config_path = get_config_layout_path();
+    if (!config_path) {
+        printf("couldn't find layout: %s loading default layout instead \n", name);
+        return;
+    }
+
+    char *file = strdup("");
+    join_path(&file, config_path);
+    join_path(&file, name);
+    join_path(&file, "init.lua");
+    if (config_path)
+        free(config_path);
+
+    struct stat st;
+    if (stat(file, &st) == -1)
+        goto cleanup;
+
+    lt->source = (struct layout_source) {
+        .exists = true,
+        .mtime_sec = st.st_mtim.tv_sec,
+        .mtime_nsec = st.st_mtim.tv_nsec,
+        .size = st.st_size,
+    };
+
+    if (load_file(L, file) != EXIT_SUCCESS) {
+        goto cleanup;
+    }
+
+cleanup:
+    free(file);
+}
+
+static void destroy_layout_template(void *data)
+{
+    destroy_layout(data);
+}
+
+struct layout *get_layout_template(lua_State *L, const char *name)
+{
+    if (!layout_templates) {
+        layout_templates = g_hash_table_new_full(
+                g_str_hash, g_str_equal, NULL, destroy_layout_template);
+    }
+
+    struct layout *template = g_hash_table_lookup(layout_templates, name);
+    if (template)
+        return template;
+
+    template = create_layout(L);
+    copy_layout_safe(template, server.default_layout);
+    free((char *)template->name);
+    template->name = strdup(name);
+    g_hash_table_insert(layout_templates, (char *)template->name, template);
+
+    // the layout file points the globals at the template, afterwards they
+    // belong to the layout that was active before
+    lua_getglobal(L, "layout");
+    lua_getglobal(L, "opt");
+    load_layout_file(L, template);
+    lua_setglobal(L, "opt");
+    lua_setglobal(L, "layout");
+    return template;
+}
+
+// returns a new reference to the value of ref
+static int lua_dup_ref(lua_State *L, int ref)
+{
+    if (ref <= 0)
+        return ref;
+    lua_rawgeti(L, LUA_REGISTRYINDEX, ref);
+    return luaL_ref(L, LUA_REGISTRYINDEX);
+}
+
+// returns a reference to a deep copy of the table of ref
+static int lua_copy_ref(lua_State *L, int ref)
+{
+    if (ref <= 0)
+        return ref;
+    int copy_ref = 0;
+    lua_rawgeti(L, LUA_REGISTRYINDEX, ref);
+    lua_copy_table(L, &copy_ref);
+    return copy_ref;
+}
+
+struct layout *create_layout_from_template(lua_State *L, struct layout *template)
+{
+    struct layout *lt = calloc(1, sizeof(*lt));
+    *lt = *template;
+
+    lt->name = strdup(template->name);
+    lt->linked_layouts = g_ptr_array_new_with_free_func(free);
+    for (int i = 0; i < template->linked_layouts->len; i++) {
+        const char *linked_layout = g_ptr_array_index(template->linked_layouts, i);
+        g_ptr_array_add(lt->linked_layouts, strdup(linked_layout));
+    }
+    lt->linked_loaded_layouts = g_ptr_array_new();
+
+    lt->options = create_options();
+    copy_options(lt->options, template->options);
+
+    // lua can't reach these, they are only ever replaced so the instances
+    // can share them with the template
+    lt->lua_master_layout_data_ref =
+        lua_dup_ref(L, template->lua_master_layout_data_ref);
+    lt->lua_resize_function_ref =
+        lua_dup_ref(L, template->lua_resize_function_ref);
+    lt->lua_layout_ref = 0;
+
+    // these tables can be changed through the layout, e.g. when resizing, so
+    // every tag gets its own and the template stays untouched
+    lt->lua_layout_copy_data_ref =
+        lua_copy_ref(L, template->lua_layout_copy_data_ref);
+    lt->lua_layout_original_copy_data_ref =
+        lua_copy_ref(L, template->lua_layout_original_copy_data_ref);
+    lt->lua_resize_data_ref = lua_copy_ref(L, template->lua_resize_data_ref);
+
+    return lt;
+}
+
+void clear_layout_templates()
+{
+    if (!layout_templates)
+        return;
+    g_hash_table_remove_all(layout_templates);
+}
+
+bool layout_source_equal(struct layout_source *source1, struct layout_source *source2)
+{
+    if (!source1->exists || !source2->exists)
+        return source1->exists == source2->exists;
+
+    return source1->mtime_sec == source2->mtime_sec
+        && source1->mtime_nsec == source2->mtime_nsec
+        && source1->size == source2->size;
+}
+
+void layout_take_state(struct layout *dest_lt, struct layout *src_lt)
+{
+    if (dest_lt->lua_layout_copy_data_ref > 0) {
+        luaL_unref(L, LUA_REGISTRYINDEX, dest_lt->lua_layout_copy_data_ref);
+    }
+    dest_lt->lua_layout_copy_data_ref = src_lt->lua_layout_copy_data_ref;
+    src_lt->lua_layout_copy_data_ref = 0;
+
+    dest_lt->n_master = src_lt->n_master;
+    dest_lt->current_max_area = src_lt->current_max_area;
+}
+
 void lua_copy_table(lua_State *L, int *ref)
 {
     // lua copy table safe will execute lua_ref_safe. This will override the
@@ -63,97 +236,117 @@ void lua_copy_table(lua_State *L, int *ref)
     return;
 }
 
-// This function represents something like that
-// function Deep_copy(orig)
-//     local orig_type = type(orig)
-//     local copy
-//     if orig_type == 'table' then
-//         copy = {}
-//         for orig_key, orig_value in next, orig, nil do
-//             copy[Deep_copy(orig_key)] = Deep_copy(orig_value)
-//         end
-//         setmetatable(copy, Deep_copy(getmetatable(orig)))
-//     else -- number, string, boolean, etc
-//         copy = orig
-//     end
-//     return copy
-// end
-//
-int deep_copy_table(lua_State *L)
+/* pushes a deep copy of the table at idx. This is the equivalent of
+ * function Deep_copy(orig)
+ *     local orig_type = type(orig)
+ *     local copy
+ *     if orig_type == 'table' then
+ *         copy = {}
+ *         for orig_key, orig_value in next, orig, nil do
+ *             copy[Deep_copy(orig_key)] = Deep_copy(orig_value)
+ *         end
+ *         setmetatable(copy, Deep_copy(getmetatable(orig)))
+ *     else -- number, string, boolean, etc
+ *         copy = orig
+ *     end
+ *     return copy
+ * end
+ * The array part is copied first with raw accesses so that layout data
+ * (arrays of arrays of numbers) is copied without a function call per
+ * element. Only nested tables recurse. */
+static void push_table_copy(lua_State *L, int idx)
 {
-    // this function takes one argument
-    // [table]
-    if (lua_istable(L, 1)) {
-        // local copy = {}
-        lua_createtable(L, 0, 0);
-        // [table, copy]
+    idx = lua_absindex(L, idx);
+    luaL_checkstack(L, 5, "table is nested too deeply to be copied");
 
-        // lenght of the original table
+    lua_Unsigned len = lua_rawlen(L, idx);
+    lua_createtable(L, len, 0);
+    int copy = lua_gettop(L);
 
-        // first key
-        lua_pushnil(L);
-        while (lua_next(L, 1) != 0) {
-            // [table, copy, k, v]
-            // we need to keep a key for lua_next to work so make a copy of it
-            lua_pushvalue(L, -2);
-            // [table, copy, k, v, k]
-
-            // get copied key
-            lua_pushcfunction(L, deep_copy_table);
-            // [table, copy, k, v, k, cfunc]
-            lua_insert(L, -2);
-            // [table, copy, k, v, cfunc, k]
-            lua_call_safe(L, 1, 1, 0);
-            // [table, copy, k, v, copied_k]
-            lua_insert(L, -2);
-            // [table, copy, k, copied_k, v]
-
-            // get copied value
-            lua_pushcfunction(L, deep_copy_table);
-            // [table, copy, k, copied_k, v, cfunc]
-            lua_insert(L, -2);
-            // [table, copy, k, copied_k, cfunc, v]
-            lua_call_safe(L, 1, 1, 0);
-            // [table, copy, k, copied_k, copied_v]
-            lua_settable(L, 2);
-
-            // we need to keep a key else lua_next won't work
-            // [table, copy, k]
+    for (lua_Unsigned i = 1; i <= len; i++) {
+        if (lua_rawgeti(L, idx, i) == LUA_TTABLE) {
+            push_table_copy(L, -1);
+            lua_remove(L, -2);
         }
+        lua_rawseti(L, copy, i);
+    }
 
-        // [table, copy]
-        if (lua_getmetatable(L, 1) == 1) {
-            // [table, copy, metatable]
-            // get copied value
-            lua_pushcfunction(L, deep_copy_table);
-            // [table, copy, metatable, cfunc]
-            lua_insert(L, -2);
-            // [table, copy, cfunc, metatable]
-            lua_call_safe(L, 1, 1, 0);
-            // [table, copy, metatable_copy]
-            lua_setmetatable(L, -2);
-            // [table, copy]
+    // copy the keys that are not part of the array
+    lua_pushnil(L);
+    while (lua_next(L, idx) != 0) {
+        // [copy, k, v]
+        if (lua_isinteger(L, -2)) {
+            lua_Integer k = lua_tointeger(L, -2);
+            if (k >= 1 && (lua_Unsigned)k <= len) {
+                lua_pop(L, 1);
+                continue;
+            }
+        }
+
+        if (lua_istable(L, -2)) {
+            push_table_copy(L, -2);
+        } else {
+            lua_pushvalue(L, -2);
         }
+        // [copy, k, v, copied_k]
+        if (lua_istable(L, -2)) {
+            push_table_copy(L, -2);
+        } else {
+            lua_pushvalue(L, -2);
+        }
+        // [copy, k, v, copied_k, copied_v]
+        lua_rawset(L, copy);
+        // [copy, k, v]
+        lua_pop(L, 1);
+        // we need to keep a key else lua_next won't work
+        // [copy, k]
+    }
+
+    if (lua_getmetatable(L, idx)) {
+        // [copy, metatable]
+        push_table_copy(L, -1);
+        lua_remove(L, -2);
+        lua_setmetatable(L, copy);
+    }
+    // [copy]
+}
+
+int deep_copy_table(lua_State *L)
+{
+    // this function takes one argument
+    // [table]
+    if (lua_istable(L, 1)) {
+        push_table_copy(L, 1);
         // [table, copy]
-        return 1;
-    } else {
-        // we only copy tables here ;)
-        return 1;
     }
+    // we only copy tables here ;)
     return 1;
 }
 
 void lua_copy_table_safe(lua_State *L, int *ref)
 {
     assert(lua_istable(L, -1));
-    lua_pushcfunction(L, deep_copy_table);
-    lua_insert(L, -2);
-    lua_call_safe(L, 1, 1, 0);
+    push_table_copy(L, -1);
+    lua_remove(L, -2);
 
     lua_ref_safe(L, LUA_REGISTRYINDEX, ref);
     return;
 }
 
+void lua_copy_table_if_new(lua_State *L, int *ref)
+{
+    if (*ref > 0) {
+        lua_rawgeti(L, LUA_REGISTRYINDEX, *ref);
+        bool is_same_table = lua_rawequal(L, -1, -2);
+        lua_pop(L, 1);
+        if (is_same_table) {
+            lua_pop(L, 1);
+            return;
+        }
+    }
+    lua_copy_table_safe(L, ref);
+}
+
 struct resize_constraints lua_toresize_constrains(lua_State *L)
 {
     struct resize_constraints resize_constraints;
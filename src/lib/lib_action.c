@@ -141,7 +141,11 @@ int lib_exec(lua_State *L)
 
     data->cmd = strdup(luaL_checkstring(L, 1));
     lua_pop(L, 1);
-    data->L = L;
+    // exec may be called from a coroutine that is collected before the
+    // command finished, so the callback is called on the main thread
+    lua_rawgeti(L, LUA_REGISTRYINDEX, LUA_RIDX_MAINTHREAD);
+    data->L = lua_tothread(L, -1);
+    lua_pop(L, 1);
 
     pthread_create(&thread, NULL, _call, data);
     pthread_detach(thread);
@@ -171,10 +175,7 @@ int lib_deep_copy(lua_State *L)
     if (lua_gettop(L) != 1) {
         luaL_error(L, "function expects exactly one argument");
     }
-    lua_pushcfunction(L, deep_copy_table);
-    lua_insert(L, -2);
-    lua_call_safe(L, 1, 1, 0);
-    return 1;
+    return deep_copy_table(L);
 }
 
 int lib_resize_main(lua_State *L)
@@ -196,7 +197,7 @@ int lib_resize_main(lua_State *L)
         return 0;
     }
 
-    lua_copy_table_safe(L, &lt->lua_layout_copy_data_ref);
+    lua_copy_table_if_new(L, &lt->lua_layout_copy_data_ref);
 
     for (int i = 0; i < lt->linked_layouts->len; i++) {
         const char *linked_layout_name = g_ptr_array_index(lt->linked_layouts, i);
@@ -209,9 +210,11 @@ int lib_resize_main(lua_State *L)
             lua_pushnumber(L, n);
             lua_pushinteger(L, dir);
 
-            lua_call_safe(L, 3, 1, 0);
+            if (lua_call_safe(L, 3, 1, 0) != LUA_OK) {
+                continue;
+            }
 
-            lua_copy_table_safe(L, &loc_lt->lua_layout_copy_data_ref);
+            lua_copy_table_if_new(L, &loc_lt->lua_layout_copy_data_ref);
         } 
     }
 
@@ -1,12 +1,30 @@
 #include "lib/lib_gmp.h"
 
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <sys/param.h>
+
 #include "translationLayer.h"
 
 #define ROUNDING_METHOD MPFR_RNDF
 
+enum gmp_operation {
+    GMP_ADD,
+    GMP_SUB,
+    GMP_MUL,
+    GMP_DIV,
+    GMP_POW,
+    GMP_MAX,
+    GMP_MIN,
+};
+
+/* numbers are doubles unless Gmp.precise is set. Doubles don't need a
+ * finalizer, so only the mpfr numbers have a __gc metamethod */
+static bool use_mpfr = false;
+
 static const struct luaL_Reg gmp_meta[] =
 {
-    {"__gc", lib_gmp_gc},
     {"__tostring", lib_gmp_tostring},
     {"__add", lib_gmp_add},
     {"__sub", lib_gmp_sub},
@@ -18,6 +36,12 @@ static const struct luaL_Reg gmp_meta[] =
     {NULL, NULL},
 };
 
+static const struct luaL_Reg gmp_mpfr_meta[] =
+{
+    {"__gc", lib_gmp_gc},
+    {NULL, NULL},
+};
+
 static const struct luaL_Reg gmp_static_methods[] =
 {
     {"new", lib_gmp_new},
@@ -28,11 +52,13 @@ static const struct luaL_Reg gmp_static_methods[] =
 
 static const struct luaL_Reg gmp_static_setter[] =
 {
+    {"precise", lib_gmp_set_precise},
     {NULL, NULL},
 };
 
 static const struct luaL_Reg gmp_static_getter[] =
 {
+    {"precise", lib_gmp_get_precise},
     {NULL, NULL},
 };
 
@@ -62,6 +88,17 @@ void lua_load_gmp(lua_State *L)
             gmp_getter,
             CONFIG_GMP);
 
+    create_class(L,
+            gmp_meta,
+            gmp_static_methods,
+            gmp_methods,
+            gmp_setter,
+            gmp_getter,
+            CONFIG_GMP_MPFR);
+    luaL_getmetatable(L, CONFIG_GMP_MPFR);
+    luaL_setfuncs(L, gmp_mpfr_meta, 0);
+    lua_pop(L, 1);
+
     create_static_accessor(L,
             "Gmp",
             gmp_static_methods,
@@ -69,115 +106,208 @@ void lua_load_gmp(lua_State *L)
             gmp_static_getter);
 }
 
-mpfr_ptr check_gmp(lua_State *L, int argn)
+static bool is_mpfr(lua_State *L, int argn)
+{
+    return luaL_testudata(L, argn, CONFIG_GMP_MPFR) != NULL;
+}
+
+double check_gmp(lua_State *L, int argn)
+{
+    if (lua_type(L, argn) == LUA_TNUMBER) {
+        return lua_tonumber(L, argn);
+    }
+    double *n = luaL_testudata(L, argn, CONFIG_GMP);
+    if (n) {
+        return *n;
+    }
+    mpfr_ptr mpfr = luaL_testudata(L, argn, CONFIG_GMP_MPFR);
+    luaL_argcheck(L, mpfr != NULL, argn, "`gmp' expected");
+    return mpfr_get_d(mpfr, ROUNDING_METHOD);
+}
+
+// initializes mpfr with the value at argn
+static void check_gmp_mpfr(lua_State *L, int argn, mpfr_t mpfr)
 {
-    void *ud = luaL_checkudata(L, argn, CONFIG_GMP);
-    luaL_argcheck(L, ud != NULL, argn, "`mpfr' expected");
-    return (mpfr_ptr)ud;
+    mpfr_ptr n = luaL_testudata(L, argn, CONFIG_GMP_MPFR);
+    if (n) {
+        mpfr_init2(mpfr, mpfr_get_prec(n));
+        mpfr_set(mpfr, n, ROUNDING_METHOD);
+        return;
+    }
+    mpfr_init(mpfr);
+    mpfr_set_d(mpfr, check_gmp(L, argn), ROUNDING_METHOD);
 }
 
-static void create_lua_gmp(lua_State *L, mpfr_t num)
+static void create_lua_gmp(lua_State *L, double n)
 {
-    mpfr_ptr mpfr = (mpfr_ptr)lua_newuserdata(L, sizeof(mpfr_t));
-    mpfr_init2(mpfr, mpfr_get_prec(num));
-    mpfr_set(mpfr, num, ROUNDING_METHOD);
+    double *user_n = lua_newuserdatauv(L, sizeof(double), 0);
+    *user_n = n;
 
     luaL_setmetatable(L, CONFIG_GMP);
 }
 
+// returns an uninitialized mpfr number that is owned by lua
+static mpfr_ptr create_lua_gmp_mpfr(lua_State *L)
+{
+    mpfr_ptr mpfr = lua_newuserdatauv(L, sizeof(mpfr_t), 0);
+    luaL_setmetatable(L, CONFIG_GMP_MPFR);
+    return mpfr;
+}
+
+static double apply_operation(enum gmp_operation operation, double n1, double n2)
+{
+    switch (operation) {
+        case GMP_ADD:
+            return n1 + n2;
+        case GMP_SUB:
+            return n1 - n2;
+        case GMP_MUL:
+            return n1 * n2;
+        case GMP_DIV:
+            return n1 / n2;
+        case GMP_POW:
+            return pow(n1, n2);
+        case GMP_MAX:
+            return MAX(n1, n2);
+        case GMP_MIN:
+            return MIN(n1, n2);
+    }
+    return 0;
+}
+
+static void apply_mpfr_operation(enum gmp_operation operation,
+        mpfr_ptr n3, mpfr_ptr n1, mpfr_ptr n2)
+{
+    switch (operation) {
+        case GMP_ADD:
+            mpfr_add(n3, n1, n2, ROUNDING_METHOD);
+            break;
+        case GMP_SUB:
+            mpfr_sub(n3, n1, n2, ROUNDING_METHOD);
+            break;
+        case GMP_MUL:
+            mpfr_mul(n3, n1, n2, ROUNDING_METHOD);
+            break;
+        case GMP_DIV:
+            mpfr_div(n3, n1, n2, ROUNDING_METHOD);
+            break;
+        case GMP_POW:
+            mpfr_pow(n3, n1, n2, ROUNDING_METHOD);
+            break;
+        case GMP_MAX:
+            mpfr_max(n3, n1, n2, ROUNDING_METHOD);
+            break;
+        case GMP_MIN:
+            mpfr_min(n3, n1, n2, ROUNDING_METHOD);
+            break;
+    }
+}
+
+/* [n1, n2]
+ * the result is a mpfr number if one of the operands is one */
+static int gmp_operation(lua_State *L, enum gmp_operation operation)
+{
+    if (!is_mpfr(L, 1) && !is_mpfr(L, 2)) {
+        double n1 = check_gmp(L, 1);
+        double n2 = check_gmp(L, 2);
+        create_lua_gmp(L, apply_operation(operation, n1, n2));
+        return 1;
+    }
+
+    // raise type errors before anything is allocated
+    check_gmp(L, 1);
+    check_gmp(L, 2);
+
+    mpfr_t n1;
+    mpfr_t n2;
+    check_gmp_mpfr(L, 1, n1);
+    check_gmp_mpfr(L, 2, n2);
+
+    mpfr_ptr n3 = create_lua_gmp_mpfr(L);
+    mpfr_init2(n3, MAX(mpfr_get_prec(n1), mpfr_get_prec(n2)));
+    apply_mpfr_operation(operation, n3, n1, n2);
+
+    mpfr_clear(n1);
+    mpfr_clear(n2);
+    return 1;
+}
+
+static bool gmp_less(lua_State *L, bool or_equal)
+{
+    if (!is_mpfr(L, 1) && !is_mpfr(L, 2)) {
+        double n1 = check_gmp(L, 1);
+        double n2 = check_gmp(L, 2);
+        return or_equal ? n1 <= n2 : n1 < n2;
+    }
+
+    check_gmp(L, 1);
+    check_gmp(L, 2);
+
+    mpfr_t n1;
+    mpfr_t n2;
+    check_gmp_mpfr(L, 1, n1);
+    check_gmp_mpfr(L, 2, n2);
+    bool res = or_equal ? mpfr_lessequal_p(n1, n2) : mpfr_less_p(n1, n2);
+    mpfr_clear(n1);
+    mpfr_clear(n2);
+    return res;
+}
+
 // meta
 int lib_gmp_gc(lua_State *L)
 {
-    mpfr_ptr n = check_gmp(L, 1);
+    mpfr_ptr n = luaL_checkudata(L, 1, CONFIG_GMP_MPFR);
     mpfr_clear(n);
     return 0;
 }
 
 int lib_gmp_tostring(lua_State *L)
 {
-    mpfr_ptr n = check_gmp(L, 1);
     char data[255];
-    mpfr_snprintf(data, 255, "%.*Rf", 10, n);
+    mpfr_ptr n = luaL_testudata(L, 1, CONFIG_GMP_MPFR);
+    if (n) {
+        mpfr_snprintf(data, 255, "%.*Rf", 10, n);
+    } else {
+        snprintf(data, 255, "%.*f", 10, check_gmp(L, 1));
+    }
     lua_pushstring(L, data);
     return 1;
 }
 
 int lib_gmp_add(lua_State *L)
 {
-    mpfr_ptr n1 = check_gmp(L, 1);
-    mpfr_ptr n2 = check_gmp(L, 2);
-
-    mpfr_t n3;
-    mpfr_init(n3);
-    mpfr_add(n3, n1, n2, ROUNDING_METHOD);
-    create_lua_gmp(L, n3);
-
-    return 1;
+    return gmp_operation(L, GMP_ADD);
 }
 
 int lib_gmp_sub(lua_State *L)
 {
-    mpfr_ptr n1 = check_gmp(L, 1);
-    mpfr_ptr n2 = check_gmp(L, 2);
-
-    mpfr_t n3;
-    mpfr_init(n3);
-    mpfr_sub(n3, n1, n2, ROUNDING_METHOD);
-    create_lua_gmp(L, n3);
-    return 1;
+    return gmp_operation(L, GMP_SUB);
 }
 
 int lib_gmp_mul(lua_State *L)
 {
-    mpfr_ptr n1 = check_gmp(L, 1);
-    mpfr_ptr n2 = check_gmp(L, 2);
-
-    mpfr_t n3;
-    mpfr_init(n3);
-    mpfr_mul(n3, n1, n2, ROUNDING_METHOD);
-    create_lua_gmp(L, n3);
-    return 1;
+    return gmp_operation(L, GMP_MUL);
 }
 
 int lib_gmp_div(lua_State *L)
 {
-    mpfr_ptr n1 = check_gmp(L, 1);
-    mpfr_ptr n2 = check_gmp(L, 2);
-
-    mpfr_t n3;
-    mpfr_init(n3);
-    mpfr_div(n3, n1, n2, ROUNDING_METHOD);
-    create_lua_gmp(L, n3);
-    return 1;
+    return gmp_operation(L, GMP_DIV);
 }
 
 int lib_gmp_pow(lua_State *L)
 {
-    mpfr_ptr n1 = check_gmp(L, 1);
-    mpfr_ptr n2 = check_gmp(L, 2);
-
-    mpfr_t n3;
-    mpfr_init(n3);
-    mpfr_pow(n3, n1, n2, ROUNDING_METHOD);
-    create_lua_gmp(L, n3);
-    return 1;
+    return gmp_operation(L, GMP_POW);
 }
 
 int lib_gmp_lt(lua_State *L)
 {
-    mpfr_ptr n1 = check_gmp(L, 1);
-    mpfr_ptr n2 = check_gmp(L, 2);
-
-    lua_pushboolean(L, mpfr_less_p(n1, n2));
+    lua_pushboolean(L, gmp_less(L, false));
     return 1;
 }
 
 int lib_gmp_le(lua_State *L)
 {
-    mpfr_ptr n1 = check_gmp(L, 1);
-    mpfr_ptr n2 = check_gmp(L, 2);
-
-    lua_pushboolean(L, mpfr_lessequal_p(n1, n2));
+    lua_pushboolean(L, gmp_less(L, true));
     return 1;
 }
 
@@ -187,42 +317,47 @@ int lib_gmp_new(lua_State *L)
     double n = luaL_checknumber(L, 1);
     lua_pop(L, 1);
 
-    mpfr_t num;
-    mpfr_init(num);
-    mpfr_set_d(num, n, ROUNDING_METHOD);
-    create_lua_gmp(L, num);
+    if (!use_mpfr) {
+        create_lua_gmp(L, n);
+        return 1;
+    }
 
+    mpfr_ptr mpfr = create_lua_gmp_mpfr(L);
+    mpfr_init(mpfr);
+    mpfr_set_d(mpfr, n, ROUNDING_METHOD);
     return 1;
 }
 
 int lib_gmp_max(lua_State *L)
 {
-    mpfr_ptr n1 = check_gmp(L, 1);
-    mpfr_ptr n2 = check_gmp(L, 2);
-
-    mpfr_t n3;
-    mpfr_init(n3);
-    mpfr_max(n3, n1, n2, ROUNDING_METHOD);
-    create_lua_gmp(L, n3);
-    return 1;
+    return gmp_operation(L, GMP_MAX);
 }
 
 int lib_gmp_min(lua_State *L)
 {
-    mpfr_ptr n1 = check_gmp(L, 1);
-    mpfr_ptr n2 = check_gmp(L, 2);
+    return gmp_operation(L, GMP_MIN);
+}
 
-    mpfr_t n3;
-    mpfr_init(n3);
-    mpfr_min(n3, n1, n2, ROUNDING_METHOD);
-    create_lua_gmp(L, n3);
+// static getter
+int lib_gmp_get_precise(lua_State *L)
+{
+    lua_pushboolean(L, use_mpfr);
     return 1;
 }
 
+// static setter
+int lib_gmp_set_precise(lua_State *L)
+{
+    use_mpfr = lua_toboolean(L, -1);
+    lua_pop(L, 1);
+    return 0;
+}
+
 // getter
 int lib_gmp_get_value(lua_State *L)
 {
-    mpfr_ptr n = check_gmp(L, 1);
-    lua_pushnumber(L, mpfr_get_d(n, ROUNDING_METHOD));
+    double n = check_gmp(L, 1);
+    lua_pop(L, 1);
+    lua_pushnumber(L, n);
     return 1;
 }
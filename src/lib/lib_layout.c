@@ -114,7 +114,7 @@ int lib_layout_load(lua_State *L)
 
     struct monitor *m = server_get_selected_monitor();
     struct tag *tag = monitor_get_active_tag(m);
-    push_layout(tag, strdup(layout_name));
+    push_layout(tag, layout_name);
 
     arrange();
     return 0;
@@ -131,9 +131,9 @@ int lib_layout_toggle(lua_State *L)
 
     if (is_layout) {
         struct layout *prev_layout = tag_get_previous_layout(tag);
-        push_layout(tag, strdup(prev_layout->name));
+        push_layout(tag, prev_layout->name);
     } else {
-        push_layout(tag, strdup(desired_layout));
+        push_layout(tag, desired_layout);
     }
 
     arrange();
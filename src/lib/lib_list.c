@@ -19,9 +19,9 @@ struct user_list {
 
 static const struct luaL_Reg list_meta[] =
 {
-    {"__gc", lib_list_gc},
     {"__index", lib_list_get},
     {"__len", lib_list_len},
+    {"__pairs", lib_list_pairs},
     {NULL, NULL},
 };
 
@@ -34,6 +34,7 @@ static const struct luaL_Reg list_methods[] = {
     {"find", lib_list_find},
     {"repush", lib_list_repush},
     {"swap", lib_list_swap},
+    {"to_table", lib_list_to_table},
     {NULL, NULL},
 };
 
@@ -46,23 +47,8 @@ static const struct luaL_Reg list_setter[] = {
     {NULL, NULL},
 };
 
-static struct user_list *create_user_list(
-        GPtrArray *list,
-        void *check_object(lua_State *L, int nagr),
-        void create_lua_object(lua_State *L, void *obj))
-{
-    struct user_list *user_list = calloc(1, sizeof(struct user_list));
-    user_list->list = list;
-    user_list->check_object = check_object;
-    user_list->create_lua_object = create_lua_object;
-    return user_list;
-}
-
-static void destroy_user_list(struct user_list *user_list)
-{
-    free(user_list);
-}
-
+/* the userdata holds the user_list itself, so no wrapper has to be allocated
+ * and freed each time a list is pushed */
 void create_lua_list(
         lua_State *L,
         GPtrArray *arr,
@@ -74,9 +60,10 @@ void create_lua_list(
         return;
     }
 
-    struct user_list *list = create_user_list(arr, check_object, create_lua_object);
-    struct user_list **user_list = lua_newuserdata(L, sizeof(struct user_list *));
-    *user_list = list;
+    struct user_list *user_list = lua_newuserdatauv(L, sizeof(struct user_list), 0);
+    user_list->list = arr;
+    user_list->create_lua_object = create_lua_object;
+    user_list->check_object = check_object;
 
     luaL_setmetatable(L, CONFIG_LIST);
 }
@@ -97,9 +84,9 @@ void lua_load_list(lua_State *L)
 
 struct user_list *check_user_list(lua_State *L, int argn)
 {
-    void **ud = luaL_checkudata(L, argn, CONFIG_LIST);
-    luaL_argcheck(L, ud != NULL, argn, "`list' expected");
-    return (struct user_list *)*ud;
+    struct user_list *user_list = luaL_checkudata(L, argn, CONFIG_LIST);
+    luaL_argcheck(L, user_list != NULL, argn, "`list' expected");
+    return user_list;
 }
 
 GPtrArray *check_list(lua_State *L, int argn)
@@ -108,12 +95,32 @@ GPtrArray *check_list(lua_State *L, int argn)
     return user_list->list;
 }
 
-int lib_list_gc(lua_State *L)
+/* [table, (int)index]
+ * iterates over a table that to_table returned like the lua ipairs function */
+int lib_list_snapshot_next(lua_State *L)
 {
-    struct user_list *user_list = check_user_list(L, 1);
-    lua_pop(L, 1);
-    destroy_user_list(user_list);
-    return 0;
+    lua_Integer i = luaL_checkinteger(L, 2) + 1;
+    if (lua_rawgeti(L, 1, i) == LUA_TNIL) {
+        return 1;
+    }
+
+    lua_pushinteger(L, i);
+    lua_insert(L, -2);
+    return 2;
+}
+
+/* callbacks in the loop may change the list, e.g. by closing a window, so
+ * the iteration runs over a snapshot of it */
+int lib_list_pairs(lua_State *L)
+{
+    lua_settop(L, 1);
+    lib_list_to_table(L);
+    // [table]
+    lua_pushcfunction(L, lib_list_snapshot_next);
+    lua_insert(L, 1);
+    lua_pushinteger(L, 0);
+    // [lib_list_snapshot_next, table, 0]
+    return 3;
 }
 
 // static methods
@@ -133,26 +140,21 @@ int lib_list_find(lua_State *L)
 
 int lib_list_get(lua_State *L)
 {
-    struct user_list *user_list = check_user_list(L, 1);
-
-    bool is_number = lua_isnumber(L, -1);
-    if (!is_number) {
-        get_lua_value(L);
-        return 1;
+    // [list, key]
+    if (lua_type(L, 2) != LUA_TNUMBER) {
+        return get_lua_value(L);
     }
 
-    int i = lua_idx_to_c_idx(lua_tonumber(L, -1));
-    if (i < 0) {
-        lua_pushnil(L);
-        return 1;
-    }
-    if (i >= user_list->list->len) {
+    // __index is only called for lists so we don't need to check the type
+    struct user_list *user_list = lua_touserdata(L, 1);
+    lua_Integer i = lua_tointeger(L, 2) - 1;
+    if (i < 0 || i >= user_list->list->len) {
         lua_pushnil(L);
         return 1;
     }
 
-    void *con = g_ptr_array_index(user_list->list, i);
-    user_list->create_lua_object(L, con);
+    void *item = g_ptr_array_index(user_list->list, i);
+    user_list->create_lua_object(L, item);
     return 1;
 }
 
@@ -197,6 +199,20 @@ int lib_list_repush(lua_State *L)
     return 0;
 }
 
+int lib_list_to_table(lua_State *L)
+{
+    struct user_list *user_list = check_user_list(L, 1);
+    lua_pop(L, 1);
+
+    GPtrArray *list = user_list->list;
+    lua_createtable(L, list->len, 0);
+    for (int i = 0; i < list->len; i++) {
+        user_list->create_lua_object(L, g_ptr_array_index(list, i));
+        lua_rawseti(L, -2, c_idx_to_lua_idx(i));
+    }
+    return 1;
+}
+
 // getter
 int lib_list_length(lua_State *L)
 {
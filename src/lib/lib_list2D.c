@@ -3,6 +3,7 @@
 #include "translationLayer.h"
 #include "server.h"
 #include "lib/lib_container.h"
+#include "lib/lib_list.h"
 #include "utils/coreUtils.h"
 #include "tile/tileUtils.h"
 #include "tagset.h"
@@ -15,6 +16,8 @@
 static const struct luaL_Reg list2D_meta[] =
 {
     {"__index", lib_list2D_get},
+    {"__len", lib_list2D_length},
+    {"__pairs", lib_list2D_pairs},
     {NULL, NULL},
 };
 
@@ -28,6 +31,7 @@ static const struct luaL_Reg list2D_methods[] = {
     {"get", lib_list2D_get},
     {"repush", lib_list2D_repush},
     {"swap", lib_list2D_swap},
+    {"to_table", lib_list2D_to_table},
     {NULL, NULL},
 };
 
@@ -73,20 +77,20 @@ GPtrArray *check_list2D(lua_State *L, int argn)
     return (GPtrArray *)*ud;
 }
 
-// static methods
-int lib_list2D_to_array(lua_State *L)
+// like lists, the iteration runs over a snapshot
+int lib_list2D_pairs(lua_State *L)
 {
-    GPtrArray *array = check_list2D(L, 1);
-    lua_pop(L, 1);
-    lua_createtable(L, array->len, 0);
-    for (int i = 0; i < array->len; i++) {
-        struct container *con = get_in_composed_list(array, i);
-        create_lua_container(L, con);
-        lua_rawseti (L, -2, i+1); /* In lua indices start at 1 */
-    }
-    return 0;
+    lua_settop(L, 1);
+    lib_list2D_to_table(L);
+    // [table]
+    lua_pushcfunction(L, lib_list_snapshot_next);
+    lua_insert(L, 1);
+    lua_pushinteger(L, 0);
+    // [lib_list_snapshot_next, table, 0]
+    return 3;
 }
 
+// static methods
 // methods
 int lib_list2D_find(lua_State *L)
 {
@@ -103,27 +107,20 @@ int lib_list2D_find(lua_State *L)
 
 int lib_list2D_get(lua_State *L)
 {
-    const char *key = luaL_checkstring(L, -1);
-    GPtrArray *array = check_list2D(L, 1);
-    debug_print("key: %s\n", key);
-
-    bool is_number = lua_isnumber(L, -1);
-    if (!is_number) {
-        get_lua_value(L);
-        return 1;
+    // [list2D, key]
+    if (lua_type(L, 2) != LUA_TNUMBER) {
+        return get_lua_value(L);
     }
-    int i = lua_tonumber(L, -1)-1;
 
-    if (i < 0) {
-        lua_pushnil(L);
-        return 1;
-    }
-    if (i >= array->len) {
+    // __index is only called for lists so we don't need to check the type
+    GPtrArray2D *array = *(GPtrArray2D **)lua_touserdata(L, 1);
+    lua_Integer i = lua_tointeger(L, 2) - 1;
+    struct container *con = i >= 0 ? get_in_composed_list(array, i) : NULL;
+    if (!con) {
         lua_pushnil(L);
         return 1;
     }
 
-    struct container *con = get_in_composed_list(array, i);
     create_lua_container(L, con);
     return 1;
 }
@@ -168,6 +165,24 @@ int lib_list2D_repush(lua_State *L)
     return 0;
 }
 
+// copies the sub lists one after another instead of looking up each index
+int lib_list2D_to_table(lua_State *L)
+{
+    GPtrArray2D *array2D = check_list2D(L, 1);
+    lua_pop(L, 1);
+
+    lua_createtable(L, length_of_composed_list(array2D), 0);
+    int n = 0;
+    for (int i = 0; i < array2D->len; i++) {
+        GPtrArray *array = g_ptr_array_index(array2D, i);
+        for (int j = 0; j < array->len; j++) {
+            create_lua_container(L, g_ptr_array_index(array, j));
+            lua_rawseti(L, -2, ++n);
+        }
+    }
+    return 1;
+}
+
 // getter
 int lib_list2D_length(lua_State *L)
 {
@@ -0,0 +1,61 @@
+#include "lib/lib_log_level.h"
+
+#include "translationLayer.h"
+#include "utils/log.h"
+
+static const struct luaL_Reg log_level_getter[] =
+{
+    {"silent", lib_log_level_get_silent},
+    {"error", lib_log_level_get_error},
+    {"warning", lib_log_level_get_warning},
+    {"info", lib_log_level_get_info},
+    {"debug", lib_log_level_get_debug},
+    {"trace", lib_log_level_get_trace},
+    {NULL, NULL},
+};
+
+void lua_load_log_level(lua_State *L)
+{
+    create_enum(L, log_level_getter, CONFIG_LOG_LEVEL);
+
+    lua_createtable(L, 0, 0);
+    luaL_setmetatable(L, CONFIG_LOG_LEVEL);
+    lua_setglobal(L, "Log_level");
+}
+
+// getter
+int lib_log_level_get_silent(lua_State *L)
+{
+    lua_pushinteger(L, LOG_LEVEL_SILENT);
+    return 1;
+}
+
+int lib_log_level_get_error(lua_State *L)
+{
+    lua_pushinteger(L, LOG_LEVEL_ERROR);
+    return 1;
+}
+
+int lib_log_level_get_warning(lua_State *L)
+{
+    lua_pushinteger(L, LOG_LEVEL_WARNING);
+    return 1;
+}
+
+int lib_log_level_get_info(lua_State *L)
+{
+    lua_pushinteger(L, LOG_LEVEL_INFO);
+    return 1;
+}
+
+int lib_log_level_get_debug(lua_State *L)
+{
+    lua_pushinteger(L, LOG_LEVEL_DEBUG);
+    return 1;
+}
+
+int lib_log_level_get_trace(lua_State *L)
+{
+    lua_pushinteger(L, LOG_LEVEL_TRACE);
+    return 1;
+}
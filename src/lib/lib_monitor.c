@@ -73,7 +73,7 @@ struct monitor *check_monitor(lua_State *L, int narg) {
     return *(struct monitor **)ud;
 }
 
-static void create_lua_monitor(lua_State *L, struct monitor *m) {
+void create_lua_monitor(lua_State *L, struct monitor *m) {
     struct monitor **user_monitor = lua_newuserdata(L, sizeof(struct monitor *));
     *user_monitor = m;
 
@@ -16,6 +16,8 @@
 #include "utils/parseConfigUtils.h"
 #include "tag.h"
 #include "lib/lib_direction.h"
+#include "layout.h"
+#include "lua_watchdog.h"
 #include "server.h"
 
 static const struct luaL_Reg options_meta[] =
@@ -45,6 +47,9 @@ static const struct luaL_Reg options_setter[] =
     {"automatic_tag_naming", lib_set_automatic_tag_naming},
     {"border_color", lib_set_border_color},
     {"border_width", lib_set_tile_border_width},
+    {"callback_demote_threshold", lib_set_callback_demote_threshold},
+    {"callback_instruction_limit", lib_set_callback_instruction_limit},
+    {"callback_time_limit", lib_set_callback_time_limit},
     {"default_layout", lib_set_default_layout},
     {"entry_focus_position_function", lib_set_entry_focus_position_function},
     {"entry_position_function", lib_set_entry_position_function},
@@ -71,6 +76,9 @@ static const struct luaL_Reg options_getter[] =
     /* {"automatic_tag_naming", lib_lua_idenity_funcion}, */
     /* {"mod", lib_lua_idenity_funcion}, */
     {"inner_gaps", lib_get_inner_gaps},
+    {"callback_demote_threshold", lib_get_callback_demote_threshold},
+    {"callback_instruction_limit", lib_get_callback_instruction_limit},
+    {"callback_time_limit", lib_get_callback_time_limit},
     /* {"outer_gaps", lib_lua_idenity_funcion}, */
     /* {"default_layout", lib_lua_idenity_funcion}, */
     /* {"border_color", lib_lua_idenity_funcion}, */
@@ -127,28 +135,61 @@ int lib_reload(lua_State *L)
     close_error_file();
     init_error_file();
 
+    /* remember the old state so that only what changed has to be applied.
+     * Only the scalar values of the old options are compared, the lists are
+     * cleared by options_reset */
+    struct options old_options = *server.default_layout->options;
+    char *old_default_layout = strdup(server.default_layout->name);
+    GPtrArray *old_tag_names = g_ptr_array_new_with_free_func(free);
+    GPtrArray *tag_names = server.default_layout->options->tag_names;
+    for (int i = 0; i < tag_names->len; i++) {
+        g_ptr_array_add(old_tag_names, strdup(g_ptr_array_index(tag_names, i)));
+    }
+
     options_reset(server.default_layout->options);
     server_reset_layout_ring(server.default_layout_ring);
+    lua_watchdog_reset();
 
-    tags_remove_loaded_layouts(server_get_tags());
+    clear_layout_templates();
     load_config(L);
 
-    // TODO: do we need to reset all layouts? or is it undesirable?
-    for (GList *iterator = server_get_tags(); iterator; iterator = iterator->next) {
-        struct tag *tag = iterator->data;
-        set_default_layout(tag);
+    bool layouts_changed = tags_reload_loaded_layouts(server_get_tags());
+    bool options_changed = !options_scalars_equal(
+            &old_options, server.default_layout->options);
+    bool tag_names_changed = !string_lists_equal(
+            old_tag_names, server.default_layout->options->tag_names);
+    bool default_layout_changed =
+        strcmp(old_default_layout, server.default_layout->name) != 0;
+
+    // tags that used the old default layout switch to the new one
+    if (default_layout_changed) {
+        for (GList *iterator = server_get_tags(); iterator; iterator = iterator->next) {
+            struct tag *tag = iterator->data;
+            if (tag->current_layout
+                    && strcmp(tag->current_layout, old_default_layout) == 0) {
+                set_default_layout(tag);
+            }
+        }
     }
 
     notify_msg("reloaded config file");
 
-    for (int i = 0; i < server.mons->len; i++) {
-        struct monitor *m = g_ptr_array_index(server.mons, i);
-        struct tag *tag = monitor_get_active_tag(m);
-        tagset_focus_tags(tag, tag->prev_tags);
+    if (tag_names_changed) {
+        for (int i = 0; i < server.mons->len; i++) {
+            struct monitor *m = g_ptr_array_index(server.mons, i);
+            struct tag *tag = monitor_get_active_tag(m);
+            tagset_focus_tags(tag, tag->prev_tags);
+        }
+        tag_update_names(server_get_tags());
+    }
+
+    if (layouts_changed || options_changed || tag_names_changed
+            || default_layout_changed) {
+        arrange();
     }
 
-    arrange();
-    tag_update_names(server_get_tags());
+    g_ptr_array_unref(old_tag_names);
+    free(old_default_layout);
     return 0;
 }
 
@@ -173,7 +214,8 @@ int lib_set_automatic_tag_naming(lua_State *L)
     lua_pop(L, 1);
 
     options->automatic_tag_naming = automatic_tag_naming;
-    ipc_event_tag();
+    struct tag *tag = monitor_get_active_tag(server_get_selected_monitor());
+    ipc_event_tag("rename", tag, NULL);
     return 0;
 }
 
@@ -218,6 +260,7 @@ int lib_set_default_layout(lua_State *L)
     const char *name = luaL_checkstring(L, -1);
     lua_pop(L, 1);
 
+    free((char *)server.default_layout->name);
     server.default_layout->name = strdup(name);
     return 0;
 }
@@ -389,8 +432,7 @@ int lib_add_rule(lua_State *L)
     struct options *options = check_options(L, 1);
     lua_pop(L, 1);
 
-    GPtrArray *rules = options->rules;
-    g_ptr_array_add(rules, rule);
+    options_add_rule(options, rule);
     return 0;
 }
 
@@ -488,6 +530,45 @@ int lib_set_smart_hidden_edges(lua_State *L)
     return 0;
 }
 
+int lib_set_callback_instruction_limit(lua_State *L)
+{
+    int callback_instruction_limit = luaL_checkinteger(L, -1);
+    lua_pop(L, 1);
+
+    struct options *options = check_options(L, 1);
+    lua_pop(L, 1);
+
+    options->callback_instruction_limit = MAX(0, callback_instruction_limit);
+
+    return 0;
+}
+
+int lib_set_callback_time_limit(lua_State *L)
+{
+    int callback_time_limit = luaL_checkinteger(L, -1);
+    lua_pop(L, 1);
+
+    struct options *options = check_options(L, 1);
+    lua_pop(L, 1);
+
+    options->callback_time_limit = MAX(0, callback_time_limit);
+
+    return 0;
+}
+
+int lib_set_callback_demote_threshold(lua_State *L)
+{
+    int callback_demote_threshold = luaL_checkinteger(L, -1);
+    lua_pop(L, 1);
+
+    struct options *options = check_options(L, 1);
+    lua_pop(L, 1);
+
+    options->callback_demote_threshold = MAX(0, callback_demote_threshold);
+
+    return 0;
+}
+
 int lib_get_sloppy_focus(lua_State *L)
 {
     struct options *options = check_options(L, 1);
@@ -507,3 +588,30 @@ int lib_get_inner_gaps(lua_State *L)
     lua_pushinteger(L, inner_gap);
     return 1;
 }
+
+int lib_get_callback_instruction_limit(lua_State *L)
+{
+    struct options *options = check_options(L, 1);
+    lua_pop(L, 1);
+
+    lua_pushinteger(L, options->callback_instruction_limit);
+    return 1;
+}
+
+int lib_get_callback_time_limit(lua_State *L)
+{
+    struct options *options = check_options(L, 1);
+    lua_pop(L, 1);
+
+    lua_pushinteger(L, options->callback_time_limit);
+    return 1;
+}
+
+int lib_get_callback_demote_threshold(lua_State *L)
+{
+    struct options *options = check_options(L, 1);
+    lua_pop(L, 1);
+
+    lua_pushinteger(L, options->callback_demote_threshold);
+    return 1;
+}
@@ -2,9 +2,11 @@
 
 #include "server.h"
 #include "translationLayer.h"
+#include "ipc/ipc.h"
 #include "lib/lib_tag.h"
 #include "lib/lib_ring_buffer.h"
 #include "ring_buffer.h"
+#include "utils/log.h"
 
 static const struct luaL_Reg server_meta[] =
 {
@@ -27,12 +29,18 @@ static const struct luaL_Reg server_methods[] =
 static const struct luaL_Reg server_setter[] =
 {
     {"default_layout_ring", lib_server_set_default_layout_ring},
+    {"ipc_drop_oldest", lib_server_set_ipc_drop_oldest},
+    {"ipc_queue_limit", lib_server_set_ipc_queue_limit},
+    {"log_level", lib_server_set_log_level},
     {NULL, NULL},
 };
 
 static const struct luaL_Reg server_getter[] =
 {
     {"default_layout_ring", lib_server_get_default_layout_ring},
+    {"ipc_drop_oldest", lib_server_get_ipc_drop_oldest},
+    {"ipc_queue_limit", lib_server_get_ipc_queue_limit},
+    {"log_level", lib_server_get_log_level},
     {NULL, NULL},
 };
 
@@ -104,6 +112,24 @@ int lib_server_get_default_layout_ring(lua_State *L)
     create_lua_ring_buffer(L, server.default_layout_ring);
     return 1;
 }
+
+int lib_server_get_ipc_drop_oldest(lua_State *L)
+{
+    lua_pushboolean(L, ipc_get_overflow_policy() == IPC_OVERFLOW_DROP_OLDEST);
+    return 1;
+}
+
+int lib_server_get_ipc_queue_limit(lua_State *L)
+{
+    lua_pushinteger(L, ipc_get_queue_limit());
+    return 1;
+}
+
+int lib_server_get_log_level(lua_State *L)
+{
+    lua_pushinteger(L, log_get_level());
+    return 1;
+}
 // setter
 int lib_server_set_default_layout_ring(lua_State *L)
 {
@@ -117,3 +143,38 @@ int lib_server_set_default_layout_ring(lua_State *L)
 
     return 0;
 }
+
+int lib_server_set_ipc_drop_oldest(lua_State *L)
+{
+    bool drop_oldest = lua_toboolean(L, -1);
+    lua_pop(L, 1);
+    check_server(L);
+    lua_pop(L, 1);
+
+    ipc_set_overflow_policy(drop_oldest
+            ? IPC_OVERFLOW_DROP_OLDEST : IPC_OVERFLOW_DISCONNECT);
+    return 0;
+}
+
+int lib_server_set_ipc_queue_limit(lua_State *L)
+{
+    lua_Integer limit = luaL_checkinteger(L, -1);
+    luaL_argcheck(L, limit > 0, 2, "the limit has to be positive");
+    lua_pop(L, 1);
+    check_server(L);
+    lua_pop(L, 1);
+
+    ipc_set_queue_limit(limit);
+    return 0;
+}
+
+int lib_server_set_log_level(lua_State *L)
+{
+    enum log_level level = luaL_checkinteger(L, -1);
+    lua_pop(L, 1);
+    check_server(L);
+    lua_pop(L, 1);
+
+    log_set_level(level);
+    return 0;
+}
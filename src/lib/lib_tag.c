@@ -171,7 +171,7 @@ int lib_tag_swap(lua_State *L)
     tag_update_names(server_get_tags());
     tag_focus_most_recent_container(tag);
     root_damage_whole(m->root);
-    ipc_event_tag();
+    ipc_event_tag("move", tag1, tag2);
     return 0;
 }
 
@@ -198,7 +198,7 @@ int lib_tag_swap_smart(lua_State *L)
     tag_update_names(server_get_tags());
     tag_this_focus_most_recent_container();
     root_damage_whole(m->root);
-    ipc_event_tag();
+    ipc_event_tag("move", tag1, tag2);
     return 0;
 }
 
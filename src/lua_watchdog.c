@@ -0,0 +1,251 @@
+#include "lua_watchdog.h"
+
+#include <lauxlib.h>
+#include <glib.h>
+#include <stdio.h>
+
+#include "layout.h"
+#include "options.h"
+#include "server.h"
+#include "utils/coreUtils.h"
+#include "utils/parseConfigUtils.h"
+
+// the hook is called at most every HOOK_INSTRUCTION_STEP instructions
+#define HOOK_INSTRUCTION_STEP 1000
+#define MSG_LEN 256
+
+struct watched_callback {
+    // keeps the function alive so that its address can't be reused
+    int func_ref;
+    int violations;
+    bool demoted;
+};
+
+static int call_depth = 0;
+static int suspend_count = 0;
+
+/* state of the current outermost call */
+static bool armed = false;
+static bool exceeded = false;
+static int blame_index = 0;
+static int hook_step = HOOK_INSTRUCTION_STEP;
+static long instruction_count = 0;
+static long instruction_limit = 0;
+// in microseconds
+static gint64 start_time = 0;
+static gint64 suspend_time = 0;
+static gint64 time_limit = 0;
+static char exceeded_reason[MSG_LEN] = "";
+// the thread the hook is installed on and the hook it had before
+static lua_State *watched_thread = NULL;
+static lua_Hook previous_hook = NULL;
+static int previous_hook_mask = 0;
+static int previous_hook_count = 0;
+
+// maps the address of a lua function to a struct watched_callback
+static GHashTable *watched_callbacks = NULL;
+
+static struct options *get_budget_options()
+{
+    if (!server.default_layout)
+        return NULL;
+    return server.default_layout->options;
+}
+
+static void watchdog_hook(lua_State *L, lua_Debug *ar)
+{
+    instruction_count += hook_step;
+
+    if (!exceeded) {
+        if (instruction_limit > 0 && instruction_count >= instruction_limit) {
+            snprintf(exceeded_reason, MSG_LEN,
+                    "exceeded the instruction limit of %ld", instruction_limit);
+            exceeded = true;
+        } else if (time_limit > 0
+                && g_get_monotonic_time() - start_time > time_limit) {
+            snprintf(exceeded_reason, MSG_LEN,
+                    "exceeded the time limit of %ldms", (long)(time_limit / 1000));
+            exceeded = true;
+        }
+    }
+
+    // raise the error on every tick so that a pcall inside of the callback
+    // can't swallow it
+    if (exceeded) {
+        luaL_error(L, "callback aborted: %s", exceeded_reason);
+    }
+}
+
+static void destroy_watched_callback(void *data)
+{
+    struct watched_callback *callback = data;
+    luaL_unref(L, LUA_REGISTRYINDEX, callback->func_ref);
+    free(callback);
+}
+
+static GHashTable *get_watched_callbacks()
+{
+    if (!watched_callbacks) {
+        watched_callbacks = g_hash_table_new_full(
+                g_direct_hash, g_direct_equal, NULL, destroy_watched_callback);
+    }
+    return watched_callbacks;
+}
+
+static void report_violation(struct watched_callback *callback)
+{
+    char msg[MSG_LEN];
+    if (callback->demoted) {
+        snprintf(msg, MSG_LEN,
+                "callback aborted: %s. It failed %d times and will be "
+                "skipped until the config is reloaded",
+                exceeded_reason, callback->violations);
+    } else {
+        snprintf(msg, MSG_LEN, "callback aborted: %s", exceeded_reason);
+    }
+
+    handle_warning(NULL, msg, 0);
+}
+
+// pops the function on top of the stack and blames it for the violation
+static void blame_callback(lua_State *L)
+{
+    const void *func = lua_topointer(L, -1);
+    GHashTable *callbacks = get_watched_callbacks();
+    struct watched_callback *callback = g_hash_table_lookup(callbacks, func);
+    if (!callback) {
+        callback = calloc(1, sizeof(*callback));
+        lua_pushvalue(L, -1);
+        callback->func_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+        g_hash_table_insert(callbacks, (void *)func, callback);
+    }
+    lua_pop(L, 1);
+
+    callback->violations++;
+    server.stats.lua.budget_violations++;
+
+    struct options *options = get_budget_options();
+    int threshold = options ? options->callback_demote_threshold : 0;
+    if (!callback->demoted && threshold > 0
+            && callback->violations >= threshold) {
+        callback->demoted = true;
+        server.stats.lua.demoted_callbacks++;
+    }
+
+    report_violation(callback);
+}
+
+void lua_watchdog_begin(lua_State *L, int nargs)
+{
+    call_depth++;
+    if (call_depth > 1)
+        return;
+
+    server.stats.lua.calls++;
+
+    struct options *options = get_budget_options();
+    if (suspend_count > 0 || !options)
+        return;
+
+    instruction_limit = options->callback_instruction_limit;
+    time_limit = (gint64)options->callback_time_limit * 1000;
+    if (instruction_limit <= 0 && time_limit <= 0)
+        return;
+
+    armed = true;
+    exceeded = false;
+    instruction_count = 0;
+    start_time = g_get_monotonic_time();
+    hook_step = HOOK_INSTRUCTION_STEP;
+    if (instruction_limit > 0 && instruction_limit < hook_step)
+        hook_step = instruction_limit;
+
+    // keep a copy of the function below it so that we know whom to blame
+    // after lua_pcall consumed it
+    lua_pushvalue(L, -nargs-1);
+    lua_insert(L, -nargs-2);
+    blame_index = lua_gettop(L) - nargs - 1;
+
+    watched_thread = L;
+    previous_hook = lua_gethook(L);
+    previous_hook_mask = lua_gethookmask(L);
+    previous_hook_count = lua_gethookcount(L);
+    lua_sethook(L, watchdog_hook, LUA_MASKCOUNT, hook_step);
+}
+
+bool lua_watchdog_end(lua_State *L, int lua_status)
+{
+    call_depth--;
+    bool aborted = exceeded && lua_status != LUA_OK;
+    if (call_depth > 0 || !armed)
+        return aborted;
+
+    // a debug hook that the config installed stays in place
+    lua_sethook(watched_thread, previous_hook,
+            previous_hook_mask, previous_hook_count);
+    watched_thread = NULL;
+    armed = false;
+
+    if (exceeded) {
+        lua_pushvalue(L, blame_index);
+        blame_callback(L);
+    }
+    exceeded = false;
+    lua_remove(L, blame_index);
+
+    return aborted;
+}
+
+bool lua_watchdog_is_exceeded()
+{
+    return exceeded;
+}
+
+/* Deferring demoted callbacks to an idle source would keep their arguments
+ * alive past the objects they point to, e.g. containers that were closed in
+ * between, and they would still exceed their budget there. So they are
+ * skipped instead. */
+bool lua_watchdog_skip(lua_State *L, int nargs)
+{
+    if (!watched_callbacks)
+        return false;
+
+    const void *func = lua_topointer(L, -nargs-1);
+    struct watched_callback *callback =
+        g_hash_table_lookup(watched_callbacks, func);
+    if (!callback || !callback->demoted)
+        return false;
+
+    lua_pop(L, nargs+1);
+    server.stats.lua.skipped_calls++;
+    return true;
+}
+
+void lua_watchdog_suspend()
+{
+    suspend_count++;
+    if (suspend_count > 1 || !armed)
+        return;
+
+    suspend_time = g_get_monotonic_time();
+    lua_sethook(watched_thread, previous_hook,
+            previous_hook_mask, previous_hook_count);
+}
+
+void lua_watchdog_resume()
+{
+    suspend_count--;
+    if (suspend_count > 0 || !armed)
+        return;
+
+    // time spent loading config files doesn't count towards the budget
+    start_time += g_get_monotonic_time() - suspend_time;
+    lua_sethook(watched_thread, watchdog_hook, LUA_MASKCOUNT, hook_step);
+}
+
+void lua_watchdog_reset()
+{
+    if (!watched_callbacks)
+        return;
+    g_hash_table_remove_all(watched_callbacks);
+}
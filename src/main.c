@@ -19,6 +19,7 @@
 #include <signal.h>
 
 #include "server.h"
+#include "startup_profile.h"
 #include "stringop.h"
 
 void print_help()
@@ -26,6 +27,7 @@ void print_help()
     printf("  -h, --help             Show help message and quit.\n"
             "  -c, --config <config>  Specify a config file.\n"
             "  -s, --startup          Specify the program which is executed on startup\n"
+            "      --startup-profile  Print how long each phase of the startup took\n"
             "\n");
 }
 
@@ -50,6 +52,7 @@ int main(int argc, char *argv[])
     struct sigaction sigint_action = {.sa_handler = SIG_IGN};
     sigaction(SIGPIPE, &sigint_action, NULL);
 
+    startup_profile_init();
     init_server();
 
     char *startup_cmd = "";
@@ -59,6 +62,7 @@ int main(int argc, char *argv[])
         {"config", required_argument, NULL, 'c'},
         {"path", required_argument, NULL, 'p'},
         {"startup", no_argument, NULL, 's'},
+        {"startup-profile", no_argument, NULL, 'P'},
         {"version", no_argument, NULL, 'v'},
         {0, 0, 0, 0}
     };
@@ -77,6 +81,9 @@ int main(int argc, char *argv[])
                 g_ptr_array_insert(server.config_paths, 0, server.custom_path);
                 g_ptr_array_insert(server.layout_paths, 0, server.custom_path);
                 break;
+            case 'P':
+                startup_profile_enable_output();
+                break;
             case 'h':
                 print_help();
                 return EXIT_SUCCESS;
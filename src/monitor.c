@@ -19,8 +19,13 @@
 #include "list_sets/container_stack_set.h"
 #include "client.h"
 #include "container.h"
+#include "event_handler.h"
+#include "ipc/ipc-server.h"
+#include "startup_profile.h"
+#include "utils/log.h"
 
 static void handle_output_frame(struct wl_listener *listener, void *data);
+static void handle_output_needs_frame(struct wl_listener *listener, void *data);
 static void handle_output_mode(struct wl_listener *listener, void *data);
 static void monitor_get_initial_tag(struct monitor *m, GList *tags);
 static void prepare_output(struct wlr_output_configuration_head_v1 *config_head, struct wlr_output *wlr_output);
@@ -52,6 +57,8 @@ void create_monitor(struct wl_listener *listener, void *data)
 
     m->frame.notify = handle_output_frame;
     wl_signal_add(&m->wlr_output->events.frame, &m->frame);
+    m->needs_frame.notify = handle_output_needs_frame;
+    wl_signal_add(&m->wlr_output->events.needs_frame, &m->needs_frame);
 
     /* Set up event listeners */
     m->destroy.notify = handle_destroy_monitor;
@@ -59,6 +66,9 @@ void create_monitor(struct wl_listener *listener, void *data)
 
     bool is_first_monitor = server.mons->len == 0;
     g_ptr_array_add(server.mons, m);
+    if (is_first_monitor) {
+        startup_phase_begin(STARTUP_PHASE_CREATE_FIRST_MONITOR);
+    }
 
     /* Adds this to the output layout. The add_auto function arranges outputs
      * from left-to-right in the order they appear. A more sophisticated
@@ -80,13 +90,17 @@ void create_monitor(struct wl_listener *listener, void *data)
 
     if (is_first_monitor) {
         server_set_selected_monitor(m);
+        startup_phase_begin(STARTUP_PHASE_INIT_UTILS);
         init_utils(L);
+        startup_phase_end(STARTUP_PHASE_INIT_UTILS);
     }
     monitor_set_selected_tag(m, get_tag(0));
     assert(m->tag_id != INVALID_TAG_ID);
 
     if (is_first_monitor) {
+        startup_phase_begin(STARTUP_PHASE_LOAD_CONFIG);
         load_config(L);
+        startup_phase_end(STARTUP_PHASE_LOAD_CONFIG);
         load_tags(server_get_tags(), server.default_layout->options->tag_names);
         server_allow_reloading_config();
 
@@ -98,8 +112,8 @@ void create_monitor(struct wl_listener *listener, void *data)
         for (GList *iterator = server_get_tags(); iterator; iterator = iterator->next) {
             struct tag *tag = iterator->data;
             // assert(tag->loaded_layouts->len == 0);
-            tag->current_layout = server.default_layout->name;
-            tag->previous_layout = server.default_layout->name;
+            tag->current_layout = g_intern_string(server.default_layout->name);
+            tag->previous_layout = g_intern_string(server.default_layout->name);
         }
     }
     struct tag *tag = monitor_get_active_tag(m);
@@ -111,8 +125,12 @@ void create_monitor(struct wl_listener *listener, void *data)
     struct layout *lt = tag_get_layout(tag);
     set_root_color(m->root, lt->options->root_color);
 
-    if (!wlr_output_commit(m->wlr_output))
-        return;
+    wlr_output_commit(m->wlr_output);
+    ipc_event_output(m);
+
+    if (is_first_monitor) {
+        startup_phase_end(STARTUP_PHASE_CREATE_FIRST_MONITOR);
+    }
 }
 
 void create_output(struct wlr_backend *backend, void *data)
@@ -137,18 +155,66 @@ void create_output(struct wlr_backend *backend, void *data)
 /* #endif */
 }
 
+/* the scene schedules a frame whenever it is damaged, which emits
+ * needs_frame. We remember the first one to know how long damage waited
+ * until it was committed. */
+static void handle_output_needs_frame(struct wl_listener *listener, void *data)
+{
+    struct monitor *m = wl_container_of(listener, m, needs_frame);
+    if (m->damage_time == 0) {
+        m->damage_time = g_get_monotonic_time();
+    }
+}
+
+static void update_frame_stats(struct monitor *m, int64_t start_time,
+        int64_t end_time)
+{
+    struct frame_stats *stats = &m->frame_stats;
+
+    int64_t commit_time = end_time - start_time;
+    stats->last_commit_time = commit_time;
+    stats->max_commit_time = MAX(stats->max_commit_time, commit_time);
+    stats->total_commit_time += commit_time;
+
+    if (m->damage_time == 0) {
+        log_trace("frame %s: commit %ldus",
+                m->wlr_output->name, (long)commit_time);
+        return;
+    }
+
+    int64_t damage_to_commit = end_time - m->damage_time;
+    m->damage_time = 0;
+    stats->last_damage_to_commit = damage_to_commit;
+    stats->max_damage_to_commit =
+        MAX(stats->max_damage_to_commit, damage_to_commit);
+    stats->total_damage_to_commit += damage_to_commit;
+    stats->damaged_commits++;
+
+    log_trace("frame %s: commit %ldus, damage to commit %ldus",
+            m->wlr_output->name, (long)commit_time, (long)damage_to_commit);
+}
+
 static void handle_output_frame(struct wl_listener *listener, void *data)
 {
     struct monitor *m = wl_container_of(listener, m, frame);
 
-	if (!wlr_scene_output_commit(m->scene_output, NULL)) {
-		return;
-	}
+    m->frame_stats.frames++;
+    if (!wlr_scene_output_needs_frame(m->scene_output)) {
+        m->frame_stats.no_damage_frames++;
+    }
+
+    int64_t start_time = g_get_monotonic_time();
+    if (!wlr_scene_output_commit(m->scene_output, NULL)) {
+        m->frame_stats.skipped_frames++;
+        log_trace("frame %s: commit failed", m->wlr_output->name);
+        return;
+    }
+    update_frame_stats(m, start_time, g_get_monotonic_time());
 
-	struct timespec now;
-	clock_gettime(CLOCK_MONOTONIC, &now);
-	wlr_scene_output_send_frame_done(m->scene_output, &now);
-    /* NOOP */
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    wlr_scene_output_send_frame_done(m->scene_output, &now);
+    startup_event_mark(STARTUP_EVENT_FIRST_FRAME);
 }
 
 static void monitor_get_initial_tag(struct monitor *m, GList *tags)
@@ -170,8 +236,12 @@ void handle_destroy_monitor(struct wl_listener *listener, void *data)
     struct monitor *m = wl_container_of(listener, m, destroy);
 
     wl_list_remove(&m->frame.link);
+    wl_list_remove(&m->needs_frame.link);
     wl_list_remove(&m->destroy.link);
 
+    event_handler_remove_monitor(server.event_handler, m);
+    ipc_event_output(m);
+
     struct tag *tag = monitor_get_active_tag(m);
     for (GList *iterator = server_get_tags(); iterator; iterator = iterator->next) {
         struct tag *tag = iterator->data;
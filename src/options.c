@@ -13,6 +13,7 @@
 #include "tag.h"
 #include "color.h"
 #include "ring_buffer.h"
+#include "rules/rule.h"
 
 GPtrArray *create_tagnames()
 {
@@ -41,11 +42,22 @@ void destroy_options(struct options *options)
     g_ptr_array_unref(options->keybindings);
 
     g_ptr_array_unref(options->mon_rules);
+    if (options->rule_index) {
+        destroy_rule_index(options->rule_index);
+    }
     g_ptr_array_unref(options->rules);
 
     free(options);
 }
 
+static void invalidate_rule_index(struct options *options)
+{
+    if (!options->rule_index)
+        return;
+    destroy_rule_index(options->rule_index);
+    options->rule_index = NULL;
+}
+
 void options_reset(struct options *options)
 {
     options->resize_dir = 0;
@@ -88,9 +100,13 @@ void options_reset(struct options *options)
     options->smart_hidden_edges = false;
     options->sloppy_focus = true;
     options->automatic_tag_naming = true;
+    options->callback_instruction_limit = 0;
+    options->callback_time_limit = 200;
+    options->callback_demote_threshold = 3;
 
     list_clear(options->mon_rules, NULL);
     list_clear(options->rules, NULL);
+    invalidate_rule_index(options);
     list_clear(options->tag_names, NULL);
     load_default_keybindings(options);
 }
@@ -112,6 +128,20 @@ static void add_keybind(struct options *options, const char *binding, const char
     options_add_keybinding(options, keybinding);
 }
 
+void options_add_rule(struct options *options, struct rule *rule)
+{
+    g_ptr_array_add(options->rules, rule);
+    invalidate_rule_index(options);
+}
+
+struct rule_index *options_get_rule_index(struct options *options)
+{
+    if (!options->rule_index) {
+        options->rule_index = create_rule_index(options->rules);
+    }
+    return options->rule_index;
+}
+
 void options_add_keybinding(struct options *options, struct keybinding *keybinding)
 {
     GPtrArray *keybindings = options->keybindings;
@@ -141,10 +171,8 @@ void options_add_keybinding(struct options *options, struct keybinding *keybindi
 
 #define bind_key(options, binding, lua_func) add_keybind(options, binding, #lua_func)
 
-void load_default_keybindings(struct options *options)
+static void create_default_keybindings(struct options *options)
 {
-    list_clear(options->keybindings, NULL);
-
     bind_key(options, "mod-S-q", server:quit());
     bind_key(options, "mod-r", opt.reload());
     bind_key(options, "mod-S-c", 
@@ -309,6 +337,36 @@ void load_default_keybindings(struct options *options)
             );
 }
 
+/* the default keybindings are compiled once per lua state and every options
+ * only holds references to them */
+static GPtrArray *default_keybindings = NULL;
+
+void reset_default_keybindings()
+{
+    if (!default_keybindings)
+        return;
+    g_ptr_array_unref(default_keybindings);
+    default_keybindings = NULL;
+}
+
+void load_default_keybindings(struct options *options)
+{
+    list_clear(options->keybindings, NULL);
+
+    if (!default_keybindings) {
+        create_default_keybindings(options);
+        default_keybindings = g_ptr_array_copy(
+                options->keybindings, copy_keybinding, NULL);
+        g_ptr_array_set_free_func(default_keybindings, destroy_keybinding0);
+        return;
+    }
+
+    for (int i = 0; i < default_keybindings->len; i++) {
+        struct keybinding *keybinding = g_ptr_array_index(default_keybindings, i);
+        g_ptr_array_add(options->keybindings, keybinding_ref(keybinding));
+    }
+}
+
 static void assign_list(
         GPtrArray **dest_arr,
         GPtrArray *src_arr,
@@ -340,11 +398,62 @@ void copy_options(struct options *dest_option, struct options *src_option)
     dest_option->hidden_edges = src_option->hidden_edges;
     dest_option->smart_hidden_edges = src_option->smart_hidden_edges;
     dest_option->automatic_tag_naming = src_option->automatic_tag_naming;
+    dest_option->callback_instruction_limit = src_option->callback_instruction_limit;
+    dest_option->callback_time_limit = src_option->callback_time_limit;
+    dest_option->callback_demote_threshold = src_option->callback_demote_threshold;
 
     assign_list(&dest_option->mon_rules, src_option->mon_rules, NULL);
     assign_list(&dest_option->rules, src_option->rules, NULL);
+    invalidate_rule_index(dest_option);
     assign_list(&dest_option->tag_names, src_option->tag_names, NULL);
+    // the keybindings are shared, no lua function has to be referenced again
     assign_list(&dest_option->keybindings, src_option->keybindings, copy_keybinding);
+    g_ptr_array_set_free_func(dest_option->keybindings, destroy_keybinding0);
+}
+
+static bool color_equal(struct color color1, struct color color2)
+{
+    return color1.red == color2.red
+        && color1.green == color2.green
+        && color1.blue == color2.blue
+        && color1.alpha == color2.alpha;
+}
+
+static bool resize_constraints_equal(struct resize_constraints c1,
+        struct resize_constraints c2)
+{
+    return c1.min_width == c2.min_width
+        && c1.max_width == c2.max_width
+        && c1.min_height == c2.min_height
+        && c1.max_height == c2.max_height;
+}
+
+bool options_scalars_equal(struct options *options1, struct options *options2)
+{
+    return color_equal(options1->root_color, options2->root_color)
+        && color_equal(options1->focus_color, options2->focus_color)
+        && color_equal(options1->border_color, options2->border_color)
+        && options1->resize_dir == options2->resize_dir
+        && resize_constraints_equal(options1->layout_constraints,
+                options2->layout_constraints)
+        && resize_constraints_equal(options1->master_constraints,
+                options2->master_constraints)
+        && options1->sloppy_focus == options2->sloppy_focus
+        && options1->key_combo_timeout == options2->key_combo_timeout
+        && options1->repeat_rate == options2->repeat_rate
+        && options1->repeat_delay == options2->repeat_delay
+        && options1->tile_border_px == options2->tile_border_px
+        && options1->float_border_px == options2->float_border_px
+        && options1->inner_gap == options2->inner_gap
+        && options1->outer_gap == options2->outer_gap
+        && options1->modkey == options2->modkey
+        && options1->arrange_by_focus == options2->arrange_by_focus
+        && options1->hidden_edges == options2->hidden_edges
+        && options1->smart_hidden_edges == options2->smart_hidden_edges
+        && options1->automatic_tag_naming == options2->automatic_tag_naming
+        && options1->callback_instruction_limit == options2->callback_instruction_limit
+        && options1->callback_time_limit == options2->callback_time_limit
+        && options1->callback_demote_threshold == options2->callback_demote_threshold;
 }
 
 int tag_get_new_position(struct tag *tag)
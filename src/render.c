@@ -11,6 +11,7 @@
 #include "list_sets/container_stack_set.h"
 #include "root.h"
 #include "tagset.h"
+#include "utils/log.h"
 
 static void surface_handle_destroy(struct wl_listener *listener, void *data)
 {
@@ -44,7 +45,7 @@ void server_handle_new_surface(struct wl_listener *listener, void *data)
 
     struct scene_surface *surface = calloc(1, sizeof(struct scene_surface));
     surface->wlr = wlr_surface;
-    printf("wlr_surface: %p\n", wlr_surface);
+    log_trace("new surface: %p", (void *)wlr_surface);
     surface->commit.notify = surface_handle_commit;
     wl_signal_add(&wlr_surface->events.commit, &surface->commit);
     surface->destroy.notify = surface_handle_destroy;
@@ -2,62 +2,298 @@
 
 #include <glib.h>
 #include <assert.h>
+#include <string.h>
 
 #include "client.h"
 #include "server.h"
 #include "tag.h"
+#include "utils/ahoCorasick.h"
 #include "utils/parseConfigUtils.h"
 #include "lib/lib_container.h"
+#include "utils/log.h"
 
-struct rule *create_rule(const char *id, const char *title, int lua_func_ref)
+static const char *rule_match_names[] = {
+    [RULE_MATCH_SUBSTRING] = "substring",
+    [RULE_MATCH_EXACT] = "exact",
+    [RULE_MATCH_PREFIX] = "prefix",
+    [RULE_MATCH_SUFFIX] = "suffix",
+    [RULE_MATCH_REGEX] = "regex",
+};
+
+// the patterns of all rules for one field of a container
+struct field_index {
+    // maps exact patterns to a GArray of rule indices
+    GHashTable *exact;
+    // substring, prefix and suffix patterns, the id is the index of the rule
+    struct aho_corasick *ac;
+    // indices of the rules that match the field with a regex
+    GArray *regex_rules;
+    // indices of the rules that have no pattern for the field
+    GArray *empty_rules;
+};
+
+struct rule_index {
+    GPtrArray *rules;
+    struct field_index app_id;
+    struct field_index title;
+};
+
+// the matches of a single field of a container
+struct field_matches {
+    GPtrArray *rules;
+    size_t text_len;
+    bool *matches;
+};
+
+// returns false if the pattern isn't a valid regex
+static bool compile_regex(const char *pattern, GRegex **regex, GError **error)
+{
+    *regex = NULL;
+    if (strcmp(pattern, "") == 0)
+        return true;
+
+    *regex = g_regex_new(pattern, G_REGEX_OPTIMIZE, 0, error);
+    return *regex != NULL;
+}
+
+struct rule *create_rule(const char *id, const char *title,
+        enum rule_match match, int lua_func_ref, GError **error)
 {
     struct rule *rule = calloc(1, sizeof(*rule));
     rule->id = strdup(id);
     rule->title = strdup(title);
+    rule->match = match;
+    if (match == RULE_MATCH_REGEX) {
+        if (!compile_regex(id, &rule->id_regex, error)
+                || !compile_regex(title, &rule->title_regex, error)) {
+            destroy_rule(rule);
+            return NULL;
+        }
+    }
     rule->lua_func_ref = lua_func_ref;
     return rule;
 }
 
 void destroy_rule(struct rule *rule)
 {
+    if (rule->id_regex) {
+        g_regex_unref(rule->id_regex);
+    }
+    if (rule->title_regex) {
+        g_regex_unref(rule->title_regex);
+    }
     free(rule->id);
     free(rule->title);
     free(rule);
 }
 
-void apply_rule(struct rule *rule, struct container *con)
+int rule_match_from_string(const char *str)
 {
-    if (rule->lua_func_ref <= 0)
-        return;
+    for (int i = 0; i < LENGTH(rule_match_names); i++) {
+        if (strcmp(rule_match_names[i], str) == 0)
+            return i;
+    }
+    return -1;
+}
 
-    bool same_id = true;
-    bool id_empty = true;
-    if (con->client->app_id) {
-        printf("appid: app: %s rule: %s\n", con->client->app_id, rule->id);
-        same_id = strstr(rule->id, con->client->app_id) != NULL;
-        id_empty = strcmp(rule->id, "") == 0;
+static const char *rule_get_pattern(struct rule *rule, enum rule_field field)
+{
+    return field == RULE_FIELD_APP_ID ? rule->id : rule->title;
+}
+
+static GRegex *rule_get_regex(struct rule *rule, enum rule_field field)
+{
+    return field == RULE_FIELD_APP_ID ? rule->id_regex : rule->title_regex;
+}
+
+static void add_index(GArray *indices, int i)
+{
+    g_array_append_val(indices, i);
+}
+
+static void create_field_index(struct field_index *field_index,
+        GPtrArray *rules, enum rule_field field)
+{
+    field_index->exact = g_hash_table_new_full(
+            g_str_hash, g_str_equal, NULL, (GDestroyNotify)g_array_unref);
+    field_index->ac = create_aho_corasick();
+    field_index->regex_rules = g_array_new(false, false, sizeof(int));
+    field_index->empty_rules = g_array_new(false, false, sizeof(int));
+
+    for (int i = 0; i < rules->len; i++) {
+        struct rule *rule = g_ptr_array_index(rules, i);
+        const char *pattern = rule_get_pattern(rule, field);
+
+        if (strcmp(pattern, "") == 0) {
+            add_index(field_index->empty_rules, i);
+            continue;
+        }
+
+        switch (rule->match) {
+            case RULE_MATCH_EXACT:
+                {
+                    GArray *indices = g_hash_table_lookup(field_index->exact, pattern);
+                    if (!indices) {
+                        indices = g_array_new(false, false, sizeof(int));
+                        g_hash_table_insert(field_index->exact, (char *)pattern, indices);
+                    }
+                    add_index(indices, i);
+                }
+                break;
+            case RULE_MATCH_REGEX:
+                add_index(field_index->regex_rules, i);
+                break;
+            case RULE_MATCH_SUBSTRING:
+            case RULE_MATCH_PREFIX:
+            case RULE_MATCH_SUFFIX:
+                aho_corasick_add(field_index->ac, pattern, i);
+                break;
+        }
     }
-    bool same_title = true;
-    bool title_empty = true;
-    if (con->client->title) {
-        printf("name: app: %s rule: %s\n", con->client->title, rule->title);
-        same_title = strstr(rule->title, con->client->title) != NULL;
-        title_empty = strcmp(rule->title, "") == 0;
+    aho_corasick_build(field_index->ac);
+}
+
+static void destroy_field_index(struct field_index *field_index)
+{
+    g_hash_table_destroy(field_index->exact);
+    destroy_aho_corasick(field_index->ac);
+    g_array_unref(field_index->regex_rules);
+    g_array_unref(field_index->empty_rules);
+}
+
+struct rule_index *create_rule_index(GPtrArray *rules)
+{
+    struct rule_index *index = calloc(1, sizeof(*index));
+    // the patterns in the index belong to the rules
+    index->rules = g_ptr_array_ref(rules);
+    create_field_index(&index->app_id, rules, RULE_FIELD_APP_ID);
+    create_field_index(&index->title, rules, RULE_FIELD_TITLE);
+    return index;
+}
+
+void destroy_rule_index(struct rule_index *index)
+{
+    destroy_field_index(&index->app_id);
+    destroy_field_index(&index->title);
+    g_ptr_array_unref(index->rules);
+    free(index);
+}
+
+static void set_matches(bool *matches, GArray *indices)
+{
+    for (int i = 0; i < indices->len; i++) {
+        matches[g_array_index(indices, int, i)] = true;
+    }
+}
+
+static void handle_pattern_match(int id, size_t start, size_t end, void *data)
+{
+    struct field_matches *field_matches = data;
+    struct rule *rule = g_ptr_array_index(field_matches->rules, id);
+
+    switch (rule->match) {
+        case RULE_MATCH_PREFIX:
+            if (start != 0)
+                return;
+            break;
+        case RULE_MATCH_SUFFIX:
+            if (end != field_matches->text_len)
+                return;
+            break;
+        default:
+            break;
+    }
+    field_matches->matches[id] = true;
+}
+
+/* sets matches[i] to true for each rule i that matches text. If text is NULL
+ * the field is unknown and doesn't restrict any rule. */
+static void match_field(struct field_index *field_index, GPtrArray *rules,
+        enum rule_field field, const char *text, bool *matches)
+{
+    if (!text) {
+        for (int i = 0; i < rules->len; i++) {
+            matches[i] = true;
+        }
+        return;
+    }
+
+    set_matches(matches, field_index->empty_rules);
+
+    GArray *exact_rules = g_hash_table_lookup(field_index->exact, text);
+    if (exact_rules) {
+        set_matches(matches, exact_rules);
     }
-    printf("same_id: %i id_empty: %i same_title: %i title_empty %i\n", same_id, id_empty, same_title, title_empty);
-    if ((same_id || id_empty) && (same_title || title_empty)) {
-        printf("apply rule\n");
-        lua_rawgeti(L, LUA_REGISTRYINDEX, rule->lua_func_ref);
-        create_lua_container(L, con);
-        lua_call_safe(L, 1, 0, 0);
+
+    struct field_matches field_matches = {
+        .rules = rules,
+        .text_len = strlen(text),
+        .matches = matches,
+    };
+    aho_corasick_match(field_index->ac, text, handle_pattern_match, &field_matches);
+
+    for (int i = 0; i < field_index->regex_rules->len; i++) {
+        int rule_index = g_array_index(field_index->regex_rules, int, i);
+        struct rule *rule = g_ptr_array_index(rules, rule_index);
+        GRegex *regex = rule_get_regex(rule, field);
+        if (regex && g_regex_match(regex, text, 0, NULL)) {
+            matches[rule_index] = true;
+        }
     }
 }
 
-void apply_rules(GPtrArray *rules, struct container *con)
+static void call_rule(struct rule *rule, struct container *con)
 {
+    lua_rawgeti(L, LUA_REGISTRYINDEX, rule->lua_func_ref);
+    create_lua_container(L, con);
+    lua_call_safe(L, 1, 0, 0);
+}
+
+static bool rule_references(struct rule *rule, enum rule_field changed)
+{
+    bool has_id = strcmp(rule->id, "") != 0;
+    bool has_title = strcmp(rule->title, "") != 0;
+
+    if ((changed & RULE_FIELD_APP_ID) && (has_id || !has_title))
+        return true;
+    if ((changed & RULE_FIELD_TITLE) && has_title)
+        return true;
+    return false;
+}
+
+void apply_rules(struct rule_index *index, struct container *con,
+        enum rule_field changed)
+{
+    GPtrArray *rules = index->rules;
+    if (rules->len == 0)
+        return;
+
+    bool *id_matches = calloc(rules->len, sizeof(*id_matches));
+    bool *title_matches = calloc(rules->len, sizeof(*title_matches));
+    match_field(&index->app_id, rules, RULE_FIELD_APP_ID,
+            con->client->app_id, id_matches);
+    match_field(&index->title, rules, RULE_FIELD_TITLE,
+            con->client->title, title_matches);
+
+    // copy the matching rules first because callbacks may add new rules
+    GPtrArray *matching_rules = g_ptr_array_new();
     for (int i = 0; i < rules->len; i++) {
         struct rule *rule = g_ptr_array_index(rules, i);
-        apply_rule(rule, con);
+        if (rule->lua_func_ref <= 0)
+            continue;
+        if (!id_matches[i] || !title_matches[i])
+            continue;
+        if (!rule_references(rule, changed))
+            continue;
+        g_ptr_array_add(matching_rules, rule);
     }
-}
+    free(id_matches);
+    free(title_matches);
 
+    log_debug("%u of %u rules match", matching_rules->len, rules->len);
+    for (int i = 0; i < matching_rules->len; i++) {
+        struct rule *rule = g_ptr_array_index(matching_rules, i);
+        call_rule(rule, con);
+    }
+    g_ptr_array_unref(matching_rules);
+}
@@ -31,10 +31,13 @@
 #include "keybinding.h"
 #include "layer_shell.h"
 #include "monitor.h"
+#include "options.h"
 #include "ring_buffer.h"
 #include "translationLayer.h"
 #include "utils/coreUtils.h"
 #include "utils/parseConfigUtils.h"
+#include "utils/log.h"
+#include "startup_profile.h"
 #include "xdg_shell.h"
 #include "container.h"
 
@@ -231,6 +234,7 @@ static void setup_event_handlers(struct server *server)
 
 static void finalize_event_handlers(struct server *server) {
     destroy_event_handler(server->event_handler);
+    server->event_handler = NULL;
 }
 
 void init_server() {
@@ -263,16 +267,25 @@ void init_server() {
 
     server_prohibit_reloading_config();
 
+    startup_phase_begin(STARTUP_PHASE_INIT_LUA_API);
     init_lua_api(&server);
+    startup_phase_end(STARTUP_PHASE_INIT_LUA_API);
     init_error_file();
+    log_init();
 
     server.default_layout_ring = create_ring_buffer();
     server_reset_layout_ring(server.default_layout_ring);
 
     server.default_layout = create_layout(L);
 
+    startup_phase_begin(STARTUP_PHASE_LOAD_LUA_API);
     load_lua_api(L);
-    if (init_backend(&server) != EXIT_SUCCESS) {
+    startup_phase_end(STARTUP_PHASE_LOAD_LUA_API);
+
+    startup_phase_begin(STARTUP_PHASE_INIT_BACKEND);
+    int backend_status = init_backend(&server);
+    startup_phase_end(STARTUP_PHASE_INIT_BACKEND);
+    if (backend_status != EXIT_SUCCESS) {
         return;
     }
 
@@ -328,6 +341,7 @@ static void run_event_loop() {
     pfds[1].events = POLLIN;
 
     server.is_running = 1;
+    startup_event_mark(STARTUP_EVENT_EVENT_LOOP);
     while (server.is_running) {
         wl_display_flush_clients(server.wl_display);
 
@@ -386,7 +400,9 @@ static void run(char *startup_cmd) {
     pid_t startup_pid = -1;
 
     initialize_wayland_display(&server);
+    startup_phase_begin(STARTUP_PHASE_START_BACKEND);
     start_backend(&server);
+    startup_phase_end(STARTUP_PHASE_START_BACKEND);
     update_monitor_geometries();
     initialize_cursor(&server);
 
@@ -403,12 +419,17 @@ static void run(char *startup_cmd) {
 }
 
 static void init_lua_api(struct server *server) {
+    // the cache of a previous state that wasn't finalized
+    reset_default_keybindings();
     L = luaL_newstate();
     luaL_openlibs(L);
     lua_setwarnf(L, handle_warning, NULL);
 }
 
-static void finalize_lua_api(struct server *server) { lua_close(L); }
+static void finalize_lua_api(struct server *server) {
+    reset_default_keybindings();
+    lua_close(L);
+}
 
 void server_reset_layout_ring(struct ring_buffer *layout_ring) {
     list_clear(layout_ring->names, NULL);
@@ -425,7 +446,7 @@ static void _async_handler_function(struct uv_async_s *arg) {
 
     lua_State *L = data->L;
     int func_ref = data->lua_func_ref;
-    printf("the end %d\n", func_ref);
+    log_trace("async callback finished: %d", func_ref);
 
     lua_rawgeti(L, LUA_REGISTRYINDEX, func_ref);
     lua_pushstring(L, data->output);
@@ -524,7 +545,10 @@ int setup_server(struct server *server) {
 
 int start_server(char *startup_cmd) {
     // Attempt to set up the server. If this fails, report the error and exit.
-    if (setup_server(&server) != 0) {
+    startup_phase_begin(STARTUP_PHASE_SETUP_SERVER);
+    int setup_status = setup_server(&server);
+    startup_phase_end(STARTUP_PHASE_SETUP_SERVER);
+    if (setup_status != 0) {
         fprintf(stderr, "Failed to set up japokwm\n");
         return EXIT_FAILURE;
     }
@@ -551,6 +575,8 @@ int stop_server() {
 
     finalize(&server);
 
+    // write the remaining messages before the error file is closed
+    log_finalize();
     close_error_file();
     wlr_output_layout_destroy(server.output_layout);
     wl_display_destroy(server.wl_display);
@@ -593,6 +619,9 @@ struct monitor *server_get_selected_monitor() {
 }
 
 void server_set_selected_monitor(struct monitor *m) {
+    if (server.selected_monitor != m) {
+        ipc_snapshot_invalidate_tags();
+    }
     server.selected_monitor = m;
 }
 
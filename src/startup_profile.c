@@ -0,0 +1,131 @@
+#include "startup_profile.h"
+
+#include <stdio.h>
+#include <time.h>
+
+struct phase_timing {
+    double begin;
+    double end;
+};
+
+static const char *phase_names[] = {
+    [STARTUP_PHASE_INIT_LUA_API] = "init_lua_api",
+    [STARTUP_PHASE_LOAD_LUA_API] = "load_lua_api",
+    [STARTUP_PHASE_INIT_BACKEND] = "init_backend",
+    [STARTUP_PHASE_SETUP_SERVER] = "setup_server",
+    [STARTUP_PHASE_START_BACKEND] = "start_backend",
+    [STARTUP_PHASE_INIT_UTILS] = "init_utils (tile.lua)",
+    [STARTUP_PHASE_LOAD_CONFIG] = "load_config",
+    [STARTUP_PHASE_CREATE_FIRST_MONITOR] = "create_monitor (first)",
+};
+
+static const char *event_names[] = {
+    [STARTUP_EVENT_EVENT_LOOP] = "event loop started",
+    [STARTUP_EVENT_FIRST_FRAME] = "first frame",
+    [STARTUP_EVENT_XWAYLAND_READY] = "xwayland ready",
+};
+
+static struct timespec start_time;
+static bool is_initialized = false;
+static bool print_output = false;
+
+static struct phase_timing phases[STARTUP_PHASE_COUNT];
+static double events[STARTUP_EVENT_COUNT];
+
+static double get_time_since_start()
+{
+    if (!is_initialized)
+        startup_profile_init();
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start_time.tv_sec) * 1000.0
+        + (now.tv_nsec - start_time.tv_nsec) / 1000000.0;
+}
+
+void startup_profile_init()
+{
+    if (is_initialized)
+        return;
+    is_initialized = true;
+
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+    for (int i = 0; i < STARTUP_PHASE_COUNT; i++) {
+        phases[i] = (struct phase_timing) {.begin = -1, .end = -1};
+    }
+    for (int i = 0; i < STARTUP_EVENT_COUNT; i++) {
+        events[i] = -1;
+    }
+}
+
+void startup_profile_enable_output()
+{
+    print_output = true;
+}
+
+void startup_phase_begin(enum startup_phase phase)
+{
+    double now = get_time_since_start();
+    if (phases[phase].begin >= 0)
+        return;
+    phases[phase].begin = now;
+}
+
+void startup_phase_end(enum startup_phase phase)
+{
+    double now = get_time_since_start();
+    if (phases[phase].begin < 0 || phases[phase].end >= 0)
+        return;
+    phases[phase].end = now;
+}
+
+double startup_phase_get_duration(enum startup_phase phase)
+{
+    if (phases[phase].end < 0)
+        return -1;
+    return phases[phase].end - phases[phase].begin;
+}
+
+double startup_event_get_time(enum startup_event event)
+{
+    return events[event];
+}
+
+static void print_profile()
+{
+    printf("startup profile:\n");
+    for (int i = 0; i < STARTUP_PHASE_COUNT; i++) {
+        double duration = startup_phase_get_duration(i);
+        if (duration < 0)
+            continue;
+        printf("  %-24s %9.3f ms (at %9.3f ms)\n",
+                phase_names[i], duration, phases[i].begin);
+    }
+    for (int i = 0; i < STARTUP_EVENT_COUNT; i++) {
+        if (events[i] < 0)
+            continue;
+        printf("  %-24s at %9.3f ms\n", event_names[i], events[i]);
+    }
+    printf("startup: time to first frame %.3f ms\n",
+            events[STARTUP_EVENT_FIRST_FRAME]);
+    fflush(stdout);
+}
+
+void startup_event_mark(enum startup_event event)
+{
+    if (events[event] >= 0)
+        return;
+    events[event] = get_time_since_start();
+
+    if (!print_output)
+        return;
+
+    if (event == STARTUP_EVENT_FIRST_FRAME) {
+        print_profile();
+    } else if (events[STARTUP_EVENT_FIRST_FRAME] >= 0) {
+        // xwayland is started lazily so it may become ready long after the
+        // profile was printed
+        printf("startup: %s at %.3f ms\n", event_names[event], events[event]);
+        fflush(stdout);
+    }
+}
@@ -41,8 +41,8 @@ void load_tags(GList *tags, GPtrArray *tag_names)
     for (int i = 0; i < tag_names->len; i++) {
         struct tag *tag = get_tag(i);
         const char *name = g_ptr_array_index(tag_names, i);
-        tag->current_layout = server.default_layout->name;
-        tag->previous_layout = server.default_layout->name;
+        tag->current_layout = g_intern_string(server.default_layout->name);
+        tag->previous_layout = g_intern_string(server.default_layout->name);
         tag_remove_loaded_layouts(tag);
         tag_rename(tag, name);
     }
@@ -67,8 +67,8 @@ struct tag *create_tag(const char *name, size_t id, struct layout *lt)
     tag->id = id;
 
     tag->loaded_layouts = g_ptr_array_new();
-    tag->current_layout = lt->name;
-    tag->previous_layout = lt->name;
+    tag->current_layout = g_intern_string(lt->name);
+    tag->previous_layout = g_intern_string(lt->name);
 
     tag->tags = bitset_create();
     tag->prev_tags = bitset_create();
@@ -503,7 +503,7 @@ BitSet *tag_get_prev_tags(struct tag *tag)
 void push_layout(struct tag *tag, const char *layout_name)
 {
     tag->previous_layout = tag->current_layout;
-    tag->current_layout = layout_name;
+    tag->current_layout = g_intern_string(layout_name);
 }
 
 void set_default_layout(struct tag *tag)
@@ -511,48 +511,15 @@ void set_default_layout(struct tag *tag)
     push_layout(tag, server.default_layout->name);
 }
 
-static void load_layout_file(lua_State *L, struct layout *lt)
-{
-    init_local_config_variables(L, lt);
-    const char *name = lt->name;
-
-    char *config_path = get_config_layout_path();
-    if (!config_path) {
-        printf("couldn't find layout: %s loading default layout instead \n", name);
-        return;
-    }
-
-    char *file = strdup("");
-    join_path(&file, config_path);
-    join_path(&file, name);
-    join_path(&file, "init.lua");
-    if (config_path)
-        free(config_path);
-
-    if (!file_exists(file))
-        goto cleanup;
-
-    if (load_file(L, file) != EXIT_SUCCESS) {
-        goto cleanup;
-    }
-
-cleanup:
-    free(file);
-}
-
 static int _load_layout(struct tag *tag, const char *layout_name)
 {
-    struct layout *lt = create_layout(L);
+    struct layout *template = get_layout_template(L, layout_name);
+    struct layout *lt = create_layout_from_template(L, template);
 
     lt->tag_id = tag->id;
-    copy_layout_safe(lt, server.default_layout);
-
-    lt->name = strdup(layout_name);
 
     int insert_position = tag->loaded_layouts->len;
     g_ptr_array_add(tag->loaded_layouts, lt);
-
-    load_layout_file(L, lt);
     return insert_position;
 }
 
@@ -575,6 +542,30 @@ int tag_load_layout(struct tag *tag, const char *layout_name)
     return insert_position;
 }
 
+bool tags_reload_loaded_layouts(GList *tags)
+{
+    bool changed = false;
+    for (GList *iter = tags; iter; iter = iter->next) {
+        struct tag *tag = iter->data;
+        for (int i = 0; i < tag->loaded_layouts->len; i++) {
+            struct layout *old_lt = g_ptr_array_index(tag->loaded_layouts, i);
+            struct layout *template = get_layout_template(L, old_lt->name);
+            struct layout *lt = create_layout_from_template(L, template);
+            lt->tag_id = tag->id;
+
+            if (layout_source_equal(&old_lt->source, &lt->source)) {
+                layout_take_state(lt, old_lt);
+            } else {
+                changed = true;
+            }
+
+            tag->loaded_layouts->pdata[i] = lt;
+            destroy_layout(old_lt);
+        }
+    }
+    return changed;
+}
+
 void focus_layout(struct tag *tag, const char *name)
 {
     assert(tag != NULL);
@@ -614,8 +605,11 @@ void tag_rename(struct tag *tag, const char *name)
 {
     if (!tag)
         return;
+    if (tag->name && strcmp(tag->name, name) == 0)
+        return;
     free(tag->name);
     tag->name = strdup(name);
+    ipc_snapshot_invalidate_tags();
 }
 
 static struct container *tag_get_local_focused_container(struct tag *tag)
@@ -673,8 +667,9 @@ void tag_focus_container(struct tag *tag, struct container *con)
     if (sel == new_sel)
         return;
 
+    ipc_event_window("focus", new_sel);
     tag_update_names(server_get_tags());
-    ipc_event_tag();
+    ipc_event_tag("rename", tag, NULL);
 }
 
 
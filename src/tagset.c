@@ -84,7 +84,7 @@ void tagset_set_tags(struct tag *sel_tag, BitSet *tags)
     arrange();
     tag_focus_most_recent_container(sel_tag);
 
-    ipc_event_tag();
+    ipc_event_tag("focus", sel_tag, NULL);
 }
 
 // you should use tagset_write_to_tags to unload tags first else
@@ -306,7 +306,7 @@ void focus_tagset(struct tag *tag, BitSet *tags)
     tagset_load_tags();
     restore_floating_containers(tag);
     update_reduced_focus_stack(tag);
-    ipc_event_tag();
+    ipc_event_tag("focus", tag, prev_tag != tag ? prev_tag : NULL);
 
     arrange_layers(m);
     tag_focus_most_recent_container(tag);
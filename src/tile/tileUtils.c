@@ -19,16 +19,21 @@
 #include "utils/gapUtils.h"
 #include "utils/parseConfigUtils.h"
 #include "event_handler.h"
+#include "ipc/ipc-server.h"
 #include "layer_shell.h"
 #include "tag.h"
 #include "list_sets/focus_stack_set.h"
 #include "tagset.h"
+#include "transaction.h"
 
 static void arrange_container(struct container *con, struct monitor *m,
         int arrange_position, struct wlr_box root_geom, int inner_gap);
 
 void arrange()
 {
+    if (transaction_defer_arrange())
+        return;
+
     for (int i = 0; i < server.mons->len; i++) {
         struct monitor *m = g_ptr_array_index(server.mons, i);
         struct tag *tag = monitor_get_active_tag(m);
@@ -220,7 +225,11 @@ int get_container_area_count(struct tag *tag)
 
 void arrange_monitor(struct monitor *m)
 {
+    struct wlr_box prev_geom = m->geom;
     wlr_output_layout_get_box(server.output_layout, m->wlr_output, &m->geom);
+    if (!box_equal(&prev_geom, &m->geom)) {
+        ipc_snapshot_invalidate_tags();
+    }
     struct wlr_box active_geom = monitor_get_active_geom(m);
 
     struct tag *tag = monitor_get_active_tag(m);
@@ -229,7 +238,8 @@ void arrange_monitor(struct monitor *m)
     container_surround_gaps(&active_geom, lt->options->outer_gap);
 
     update_layout_counters(tag);
-    call_update_function(server.event_handler, lt->n_area);
+    event_handler_update_tag(server.event_handler, tag);
+    event_handler_update_monitor(server.event_handler, m);
 
     GPtrArray *tiled_containers = tag_get_tiled_list_copy(tag);
 
@@ -299,7 +309,12 @@ static void arrange_container(struct container *con, struct monitor *m,
         container_set_border_width(con, direction_value_uniform(lt->options->tile_border_px));
     }
 
+    struct wlr_box prev_geom = container_get_current_geom(con);
     container_set_tiled_geom(con, geom);
+    struct wlr_box new_geom = container_get_current_geom(con);
+    if (!box_equal(&prev_geom, &new_geom)) {
+        event_handler_mark_container(server.event_handler, con);
+    }
     container_update_size(con);
 }
 
@@ -355,6 +370,9 @@ void update_hidden_status_of_containers(struct monitor *m, GPtrArray *tiled_cont
         struct container *con = g_ptr_array_index(tiled_containers, i);
 
         bool is_hidden = i >= lt->n_tiled;
+        if (container_get_hidden(con) != is_hidden) {
+            event_handler_mark_container(server.event_handler, con);
+        }
         container_set_hidden(con, is_hidden);
     }
 }
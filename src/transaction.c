@@ -0,0 +1,50 @@
+#include "transaction.h"
+
+#include <assert.h>
+
+#include "ipc/ipc-server.h"
+#include "server.h"
+#include "tile/tileUtils.h"
+
+static int depth = 0;
+static bool arrange_pending = false;
+
+void transaction_begin()
+{
+    if (depth == 0) {
+        ipc_events_hold();
+        server.stats.ipc.transactions++;
+    }
+    depth++;
+}
+
+void transaction_commit()
+{
+    assert(depth > 0);
+    depth--;
+    if (depth > 0)
+        return;
+
+    if (arrange_pending) {
+        arrange_pending = false;
+        arrange();
+    }
+    ipc_events_release();
+}
+
+bool transaction_is_active()
+{
+    return depth > 0;
+}
+
+bool transaction_defer_arrange()
+{
+    if (depth == 0)
+        return false;
+
+    if (arrange_pending) {
+        server.stats.ipc.deferred_arranges++;
+    }
+    arrange_pending = true;
+    return true;
+}
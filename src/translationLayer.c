@@ -23,6 +23,7 @@
 #include "lib/lib_layout.h"
 #include "lib/lib_list.h"
 #include "lib/lib_list2D.h"
+#include "lib/lib_log_level.h"
 #include "lib/lib_monitor.h"
 #include "lib/lib_options.h"
 #include "lib/lib_output_transform.h"
@@ -34,136 +35,114 @@
 #include "lib/local_options.h"
 #include "server.h"
 #include "stringop.h"
+#include "utils/bytecodeCache.h"
 #include "utils/coreUtils.h"
 #include "utils/parseConfigUtils.h"
 #include "utils/parseConfigUtils.h"
 #include "tag.h"
 
-const struct luaL_Reg meta[] = 
+/* [table, key]
+ * methods are looked up in the metatable at meta_idx and properties are
+ * resolved by calling the getter from the table at getter_idx directly */
+static int index_class(lua_State *L, int meta_idx, int getter_idx)
 {
-    {"__index", get_lua_value},
-    {"__newindex", set_lua_value},
-    {NULL, NULL},
-};
-
-/* set a lua value
- * */
-int set_lua_value(lua_State *L)
-{
-    // [table, key, value]
-    const char *key = luaL_checkstring(L, -2);
+    lua_pushvalue(L, 2);
+    lua_rawget(L, meta_idx);
+    // [table, key, ..., (cfunction|nil)meta.key]
+    if (!lua_isnil(L, -1)) {
+        return 1;
+    }
+    lua_pop(L, 1);
 
-    lua_getmetatable(L, -3); {
-        // [table, key, value, meta]
-        lua_pushstring(L, "setter");
-        // [table, key, value, meta, "setter"]
-        lua_gettable(L, -2);
-        // [table, key, value, meta, (table)meta."setter"]
-        lua_pushstring(L, key);
-        // [table, key, value, meta, (table)meta."setter", key]
-        lua_gettable(L, -2);
-        // [table, key, value, meta, (table)meta."setter", (value)meta."setter".key]
-        if (lua_isnil(L, -1)) {
-            lua_pop(L, 6);
+    lua_pushvalue(L, 2);
+    lua_rawget(L, getter_idx);
+    // [table, key, ..., (cfunction|nil)getter.key]
+    lua_CFunction getter = lua_tocfunction(L, -1);
+    if (!getter) {
+        lua_pushnil(L);
+        return 1;
+    }
 
-            luaL_where(L, 1);
-            const char *where = luaL_checkstring(L, -1);
-            char *res = g_strconcat(
-                    where,
-                    key,
-                    " can't be set. Adding new values to lib tables is illegal",
-                    NULL);
-            // from here on using the variable that was on the stack may
-            // lead to segfaults because lua may garbage collect them
-            lua_pop(L, 1);
-            lua_pushstring(L, res);
-            lua_warning(L, res, false);
-            free(res);
-            // lua_error(L);
-            return 0;
-        }
-        lua_pop(L, 2);
-        // [table, key, value, meta]
-        lua_pushstring(L, "setter");
-        // [table, key, value, meta, "setter"]
-        lua_gettable(L, -2); {
-            // [table, key, value, meta, (table)meta."setter"]
-            lua_pushstring(L, key);
-            // [table, key, value, meta, (table)meta."setter", key]
-            lua_gettable(L, -2); {
+    lua_settop(L, 1);
+    // [table]
+    return getter(L);
+}
 
-                // [table, key, value, meta, (table)meta."setter",
-                // (cfunction)meta."setter".key]
-                lua_pushvalue(L, -6);
-                // [table, key, value, meta, (table)meta."setter",
-                // (cfunction)meta."setter".key, table]
-                lua_pushvalue(L, -5);
-                // [table, key, value, meta, (table)meta."setter",
-                // (cfunction)meta."setter".key, table, value]
-                lua_pcall(L, 2, 0, 0);
-                // [table, key, value, meta, (table)meta."setter"]
+/* [table, key, value] */
+static int newindex_class(lua_State *L, int setter_idx)
+{
+    lua_pushvalue(L, 2);
+    lua_rawget(L, setter_idx);
+    // [table, key, value, ..., (cfunction|nil)setter.key]
+    lua_CFunction setter = lua_tocfunction(L, -1);
+    if (!setter) {
+        const char *key = luaL_tolstring(L, 2, NULL);
+        luaL_where(L, 1);
+        const char *where = luaL_checkstring(L, -1);
+        char *res = g_strconcat(
+                where,
+                key,
+                " can't be set. Adding new values to lib tables is illegal",
+                NULL);
+        lua_settop(L, 0);
+        lua_warning(L, res, false);
+        free(res);
+        return 0;
+    }
 
-            } lua_pop(L, 1);
-            // [table, key, value, meta]
+    lua_settop(L, 3);
+    lua_remove(L, 2);
+    // [table, value]
+    setter(L);
+    return 0;
+}
 
-            lua_pop(L, 1);
-            // [table, key, value]
+// upvalues: metatable, getter table
+static int class_index(lua_State *L)
+{
+    return index_class(L, lua_upvalueindex(1), lua_upvalueindex(2));
+}
 
-        } lua_pop(L, 1);
-        // [table, key]
-    } lua_pop(L, 1);
-    // [table]
+// upvalues: setter table
+static int class_newindex(lua_State *L)
+{
+    return newindex_class(L, lua_upvalueindex(1));
+}
 
-    lua_pop(L, 1);
-    // []
+void set_class_accessors(lua_State *L)
+{
+    // [meta]
+    lua_pushstring(L, "__index");
+    lua_pushvalue(L, -2);
+    lua_getfield(L, -3, "getter");
+    lua_pushcclosure(L, class_index, 2);
+    lua_settable(L, -3);
+
+    lua_pushstring(L, "__newindex");
+    lua_getfield(L, -2, "setter");
+    lua_pushcclosure(L, class_newindex, 1);
+    lua_settable(L, -3);
+}
 
-    return 0;
+/* set a lua value. This is the slow path for metamethods that handle some
+ * keys themselves and have to look up the metatable first.
+ * */
+int set_lua_value(lua_State *L)
+{
+    // [table, key, value]
+    lua_getmetatable(L, 1);
+    lua_getfield(L, -1, "setter");
+    // [table, key, value, meta, (table)meta."setter"]
+    return newindex_class(L, lua_gettop(L));
 }
 
-/* this is very bad code I know... I returns the metatable after going through
- * the getter function */
 int get_lua_value(lua_State *L)
 {
     // [table, key]
-    const char *key = luaL_checkstring(L, -1);
-
-    // call functions if available
-    lua_getmetatable(L, -2);
-    // [table, key, meta]
-    lua_pushstring(L, key);
-    // [table, key, meta, key]
-    lua_gettable(L, -2);
-    // [table, key, meta, (cfunction|NULL)meta.key]
-    if (!lua_isnil(L, -1)) {
-        lua_insert(L, -3);
-        // [(cfunction|NULL)meta.key, table, key]
-        lua_pop(L, 2);
-        // [(cfunction|NULL)meta.key]
-        return 1;
-    }
-    lua_pop(L, 2);
-    // [table, key]
-
-    lua_getmetatable(L, -2);
-    // [table, key, meta]
-
-    lua_pushstring(L, "getter");
-    // [table, key, meta, "getter"]
-    lua_gettable(L, -2);
+    lua_getmetatable(L, 1);
+    lua_getfield(L, -1, "getter");
     // [table, key, meta, (table)meta."getter"]
-    lua_pushstring(L, key);
-    // [table, key, meta, (table)meta."getter", key]
-    lua_gettable(L, -2);
-    // [table, key, meta, (table)meta."getter", (cfunc)meta."getter".key]
-    lua_pushvalue(L, -5);
-    // [table, key, meta, (table)meta."getter", (cfunc)meta."getter".key, table]
-    lua_pcall(L, 1, 1, 0);
-    // [table, key, meta, (table)meta."getter", retval]
-    lua_insert(L, -5);
-    // [retval, table, key, meta, (table)meta."getter".key]
-    lua_pop(L, 4);
-    // [retval]
-    return 1;
+    return index_class(L, lua_gettop(L)-1, lua_gettop(L));
 }
 
 // function to convert a lua value to a string
@@ -264,6 +243,8 @@ void load_lua_api(lua_State *L)
     luaL_setfuncs(L, mylib, 0);
     lua_pop(L, 1);
 
+    bytecode_cache_install_searcher(L);
+
     lua_load_action(L);
     lua_load_bitset(L);
     lua_load_color(L);
@@ -280,6 +261,7 @@ void load_lua_api(lua_State *L)
     lua_load_layout(L);
     lua_load_list(L);
     lua_load_list2D(L);
+    lua_load_log_level(L);
     lua_load_monitor(L);
     lua_load_options(L);
     lua_load_output_transform(L);
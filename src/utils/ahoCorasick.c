@@ -0,0 +1,170 @@
+#include "utils/ahoCorasick.h"
+
+#include <assert.h>
+#include <glib.h>
+#include <stdlib.h>
+
+#define ROOT 0
+
+struct ac_node {
+    // the node of the longest proper suffix that is in the trie
+    int fail;
+    // the next node in the fail chain that ends a pattern, -1 if none
+    int dict_link;
+    int depth;
+    // the byte of the transition from the parent to this node
+    unsigned char byte;
+    // ids of the patterns that end in this node
+    GArray *pattern_ids;
+    GArray *children;
+};
+
+struct aho_corasick {
+    GArray *nodes;
+    /* maps node*256 + byte to the child node. The root is never a child, so
+     * NULL means that there is no transition */
+    GHashTable *transitions;
+    bool built;
+};
+
+static int add_node(struct aho_corasick *ac, int depth, unsigned char byte)
+{
+    struct ac_node node = {
+        .fail = ROOT,
+        .dict_link = -1,
+        .depth = depth,
+        .byte = byte,
+        .pattern_ids = NULL,
+        .children = g_array_new(false, false, sizeof(int)),
+    };
+    g_array_append_val(ac->nodes, node);
+    return ac->nodes->len-1;
+}
+
+static struct ac_node *get_node(struct aho_corasick *ac, int i)
+{
+    return &g_array_index(ac->nodes, struct ac_node, i);
+}
+
+static void *transition_key(int node, unsigned char c)
+{
+    return GINT_TO_POINTER(node * 256 + c);
+}
+
+static int get_child(struct aho_corasick *ac, int node, unsigned char c)
+{
+    void *child = g_hash_table_lookup(ac->transitions, transition_key(node, c));
+    return GPOINTER_TO_INT(child);
+}
+
+struct aho_corasick *create_aho_corasick()
+{
+    struct aho_corasick *ac = calloc(1, sizeof(*ac));
+    ac->nodes = g_array_new(false, false, sizeof(struct ac_node));
+    ac->transitions = g_hash_table_new(g_direct_hash, g_direct_equal);
+    add_node(ac, 0, 0);
+    return ac;
+}
+
+void destroy_aho_corasick(struct aho_corasick *ac)
+{
+    for (int i = 0; i < ac->nodes->len; i++) {
+        struct ac_node *node = get_node(ac, i);
+        if (node->pattern_ids) {
+            g_array_unref(node->pattern_ids);
+        }
+        g_array_unref(node->children);
+    }
+    g_array_unref(ac->nodes);
+    g_hash_table_destroy(ac->transitions);
+    free(ac);
+}
+
+void aho_corasick_add(struct aho_corasick *ac, const char *pattern, int id)
+{
+    assert(!ac->built);
+
+    int node = ROOT;
+    for (const unsigned char *c = (const unsigned char *)pattern; *c; c++) {
+        int child = get_child(ac, node, *c);
+        if (child == ROOT) {
+            int depth = get_node(ac, node)->depth + 1;
+            child = add_node(ac, depth, *c);
+            g_hash_table_insert(ac->transitions,
+                    transition_key(node, *c), GINT_TO_POINTER(child));
+            g_array_append_val(get_node(ac, node)->children, child);
+        }
+        node = child;
+    }
+
+    struct ac_node *end = get_node(ac, node);
+    if (!end->pattern_ids) {
+        end->pattern_ids = g_array_new(false, false, sizeof(int));
+    }
+    g_array_append_val(end->pattern_ids, id);
+}
+
+void aho_corasick_build(struct aho_corasick *ac)
+{
+    // breadth first so that the fail links of shorter suffixes exist already
+    GQueue *queue = g_queue_new();
+    g_queue_push_tail(queue, GINT_TO_POINTER(ROOT));
+    while (!g_queue_is_empty(queue)) {
+        int parent = GPOINTER_TO_INT(g_queue_pop_head(queue));
+        GArray *children = get_node(ac, parent)->children;
+
+        for (int i = 0; i < children->len; i++) {
+            int node = g_array_index(children, int, i);
+            g_queue_push_tail(queue, GINT_TO_POINTER(node));
+            if (parent == ROOT)
+                continue;
+
+            unsigned char c = get_node(ac, node)->byte;
+            int fail = get_node(ac, parent)->fail;
+            while (fail != ROOT && get_child(ac, fail, c) == ROOT) {
+                fail = get_node(ac, fail)->fail;
+            }
+            int fail_child = get_child(ac, fail, c);
+
+            struct ac_node *fail_node = get_node(ac, fail_child);
+            struct ac_node *child = get_node(ac, node);
+            child->fail = fail_child;
+            child->dict_link = fail_node->pattern_ids
+                ? fail_child : fail_node->dict_link;
+        }
+    }
+    g_queue_free(queue);
+    ac->built = true;
+}
+
+static void report_matches(struct ac_node *node, size_t end,
+        aho_corasick_match_func match_func, void *data)
+{
+    for (int i = 0; i < node->pattern_ids->len; i++) {
+        int id = g_array_index(node->pattern_ids, int, i);
+        match_func(id, end - node->depth, end, data);
+    }
+}
+
+void aho_corasick_match(struct aho_corasick *ac, const char *text,
+        aho_corasick_match_func match_func, void *data)
+{
+    assert(ac->built);
+
+    int node = ROOT;
+    const unsigned char *str = (const unsigned char *)text;
+    for (size_t i = 0; str[i]; i++) {
+        while (node != ROOT && get_child(ac, node, str[i]) == ROOT) {
+            node = get_node(ac, node)->fail;
+        }
+        node = get_child(ac, node, str[i]);
+
+        struct ac_node *current = get_node(ac, node);
+        if (current->pattern_ids) {
+            report_matches(current, i+1, match_func, data);
+        }
+        for (int j = current->dict_link; j != -1; j = get_node(ac, j)->dict_link) {
+            report_matches(get_node(ac, j), i+1, match_func, data);
+        }
+    }
+}
@@ -0,0 +1,244 @@
+#include "utils/bytecodeCache.h"
+
+#include <fcntl.h>
+#include <glib.h>
+#include <lauxlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "utils/log.h"
+
+#define CACHE_MAGIC "JPKLUAC"
+
+/* a cache file consists of this header followed by the path of the source
+ * file and the bytecode */
+struct cache_header {
+    char magic[sizeof(CACHE_MAGIC)];
+    uint32_t lua_version;
+    uint32_t path_len;
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+    int64_t size;
+};
+
+static struct cache_header create_header(const char *file, struct stat *st)
+{
+    struct cache_header header = {
+        .magic = CACHE_MAGIC,
+        .lua_version = LUA_VERSION_NUM,
+        .path_len = strlen(file),
+        .mtime_sec = st->st_mtim.tv_sec,
+        .mtime_nsec = st->st_mtim.tv_nsec,
+        .size = st->st_size,
+    };
+    return header;
+}
+
+static char *get_cache_dir()
+{
+    const char *cache_home = getenv("XDG_CACHE_HOME");
+    if (cache_home && cache_home[0] != '\0')
+        return g_build_filename(cache_home, "japokwm", NULL);
+
+    const char *home = getenv("HOME");
+    if (!home)
+        return NULL;
+    return g_build_filename(home, ".cache", "japokwm", NULL);
+}
+
+char *bytecode_cache_get_path(const char *file)
+{
+    char *cache_dir = get_cache_dir();
+    if (!cache_dir)
+        return NULL;
+
+    char *checksum = g_compute_checksum_for_string(G_CHECKSUM_SHA1, file, -1);
+    char *cache_file = g_strconcat(checksum, ".luac", NULL);
+    char *path = g_build_filename(cache_dir, cache_file, NULL);
+
+    g_free(cache_file);
+    g_free(checksum);
+    g_free(cache_dir);
+    return path;
+}
+
+// pushes the cached chunk and returns true if the cache is valid
+static bool load_cached_chunk(lua_State *L, const char *file,
+        const char *chunkname, struct stat *st, const char *cache_path)
+{
+    int fd = open(cache_path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        return false;
+
+    struct stat cache_st;
+    if (fstat(fd, &cache_st) == -1
+            || cache_st.st_size < (off_t)sizeof(struct cache_header)) {
+        close(fd);
+        return false;
+    }
+
+    size_t len = cache_st.st_size;
+    char *data = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+
+    struct cache_header header;
+    memcpy(&header, data, sizeof(header));
+    struct cache_header expected = create_header(file, st);
+    size_t offset = sizeof(header) + header.path_len;
+
+    bool is_valid = memcmp(header.magic, expected.magic, sizeof(header.magic)) == 0
+        && header.lua_version == expected.lua_version
+        && header.path_len == expected.path_len
+        && header.mtime_sec == expected.mtime_sec
+        && header.mtime_nsec == expected.mtime_nsec
+        && header.size == expected.size
+        && offset <= len
+        && memcmp(data + sizeof(header), file, header.path_len) == 0;
+
+    bool loaded = false;
+    if (is_valid) {
+        // "b" makes sure that we never interpret a broken cache as source
+        if (luaL_loadbufferx(L, data + offset, len - offset, chunkname, "b")
+                == LUA_OK) {
+            loaded = true;
+        } else {
+            log_debug("invalid bytecode cache %s: %s",
+                    cache_path, lua_tostring(L, -1));
+            lua_pop(L, 1);
+        }
+    }
+
+    munmap(data, len);
+    return loaded;
+}
+
+static int write_chunk(lua_State *L, const void *p, size_t size, void *data)
+{
+    GByteArray *buffer = data;
+    g_byte_array_append(buffer, p, size);
+    return 0;
+}
+
+static bool write_all(int fd, const guint8 *data, size_t len)
+{
+    while (len > 0) {
+        ssize_t written = write(fd, data, len);
+        if (written == -1)
+            return false;
+        data += written;
+        len -= written;
+    }
+    return true;
+}
+
+// stores the function on top of the stack in the cache
+static void store_chunk(lua_State *L, const char *file, struct stat *st,
+        const char *cache_path)
+{
+    struct cache_header header = create_header(file, st);
+
+    GByteArray *buffer = g_byte_array_new();
+    g_byte_array_append(buffer, (guint8 *)&header, sizeof(header));
+    g_byte_array_append(buffer, (guint8 *)file, header.path_len);
+    // keep the debug information so that errors still point to the source
+    lua_dump(L, write_chunk, buffer, false);
+
+    char *cache_dir = g_path_get_dirname(cache_path);
+    g_mkdir_with_parents(cache_dir, 0700);
+    g_free(cache_dir);
+
+    // write to a temporary file first so that a concurrently starting
+    // instance never sees a partially written cache
+    char *tmp_path = g_strconcat(cache_path, ".XXXXXX", NULL);
+    int fd = g_mkstemp(tmp_path);
+    if (fd == -1) {
+        log_debug("can't create bytecode cache %s", tmp_path);
+        goto cleanup;
+    }
+
+    bool success = write_all(fd, buffer->data, buffer->len);
+    close(fd);
+    if (!success || rename(tmp_path, cache_path) == -1) {
+        log_debug("can't write bytecode cache %s", cache_path);
+        unlink(tmp_path);
+    }
+
+cleanup:
+    g_free(tmp_path);
+    g_byte_array_unref(buffer);
+}
+
+int bytecode_cache_loadfile(lua_State *L, const char *file)
+{
+    struct stat st;
+    if (stat(file, &st) == -1)
+        return luaL_loadfile(L, file);
+
+    char *cache_path = bytecode_cache_get_path(file);
+    if (!cache_path)
+        return luaL_loadfile(L, file);
+
+    // the same chunkname as luaL_loadfile uses
+    char *chunkname = g_strconcat("@", file, NULL);
+
+    int status = LUA_OK;
+    if (!load_cached_chunk(L, file, chunkname, &st, cache_path)) {
+        status = luaL_loadfile(L, file);
+        if (status == LUA_OK) {
+            store_chunk(L, file, &st, cache_path);
+        }
+    }
+
+    g_free(chunkname);
+    g_free(cache_path);
+    return status;
+}
+
+/* replaces the searcher of lua modules. It looks up the module exactly like
+ * the default searcher but loads it through the cache */
+static int search_cached_module(lua_State *L)
+{
+    // [name]
+    const char *name = luaL_checkstring(L, 1);
+
+    lua_getglobal(L, "package");
+    lua_getfield(L, -1, "searchpath");
+    lua_pushstring(L, name);
+    lua_getfield(L, -3, "path");
+    lua_call(L, 2, 2);
+    // [name, package, (string|nil)file, (string|nil)error]
+    if (lua_isnil(L, -2)) {
+        // the error explains where the module was searched
+        return 1;
+    }
+
+    const char *file = lua_tostring(L, -2);
+    if (bytecode_cache_loadfile(L, file) != LUA_OK) {
+        return luaL_error(L, "error loading module '%s' from file '%s':\n\t%s",
+                name, file, lua_tostring(L, -1));
+    }
+    // [name, package, file, error, chunk]
+    lua_pushvalue(L, -3);
+    // [name, package, file, error, chunk, file]
+    return 2;
+}
+
+void bytecode_cache_install_searcher(lua_State *L)
+{
+    lua_getglobal(L, "package");
+    lua_getfield(L, -1, "searchers");
+    // [package, searchers]
+
+    // searchers[2] is the searcher for lua files
+    lua_pushcfunction(L, search_cached_module);
+    lua_rawseti(L, -2, 2);
+    lua_pop(L, 2);
+}
@@ -38,6 +38,26 @@ void wlr_list_cat(GPtrArray *dest, GPtrArray *src)
     }
 }
 
+bool string_lists_equal(GPtrArray *list1, GPtrArray *list2)
+{
+    if (list1->len != list2->len)
+        return false;
+
+    for (int i = 0; i < list1->len; i++) {
+        const char *str1 = g_ptr_array_index(list1, i);
+        const char *str2 = g_ptr_array_index(list2, i);
+        if (strcmp(str1, str2) != 0)
+            return false;
+    }
+    return true;
+}
+
+bool box_equal(const struct wlr_box *box1, const struct wlr_box *box2)
+{
+    return box1->x == box2->x && box1->y == box2->y
+        && box1->width == box2->width && box1->height == box2->height;
+}
+
 void list_insert(GPtrArray *array, int i, void *item)
 {
     if (array->len <= 0) {
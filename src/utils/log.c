@@ -0,0 +1,164 @@
+#include "utils/log.h"
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "utils/parseConfigUtils.h"
+
+// must be a power of two
+#define LOG_SLOT_COUNT 256
+#define LOG_MSG_LEN 256
+
+struct log_slot {
+    enum log_level level;
+    struct timespec time;
+    char msg[LOG_MSG_LEN];
+};
+
+enum log_level log_runtime_level = LOG_LEVEL_INFO;
+
+/* single producer (the main thread) single consumer (the flush thread) ring
+ * buffer. head is only written by the producer and tail only by the
+ * consumer. */
+static struct log_slot slots[LOG_SLOT_COUNT];
+static atomic_uint head = 0;
+static atomic_uint tail = 0;
+static atomic_ulong dropped_count = 0;
+
+static sem_t pending;
+static pthread_t flush_thread;
+static atomic_bool is_running = false;
+static struct timespec start_time;
+
+static const char *log_level_names[] = {
+    [LOG_LEVEL_SILENT] = "SILENT",
+    [LOG_LEVEL_ERROR] = "ERROR",
+    [LOG_LEVEL_WARNING] = "WARNING",
+    [LOG_LEVEL_INFO] = "INFO",
+    [LOG_LEVEL_DEBUG] = "DEBUG",
+    [LOG_LEVEL_TRACE] = "TRACE",
+};
+
+const char *log_level_to_string(enum log_level level)
+{
+    if (level < LOG_LEVEL_SILENT || level > LOG_LEVEL_TRACE)
+        return "UNKNOWN";
+    return log_level_names[level];
+}
+
+static void write_slot(struct log_slot *slot)
+{
+    long sec = slot->time.tv_sec - start_time.tv_sec;
+    long nsec = slot->time.tv_nsec - start_time.tv_nsec;
+    if (nsec < 0) {
+        sec--;
+        nsec += 1000000000;
+    }
+
+    char line[64 + LOG_MSG_LEN];
+    snprintf(line, sizeof(line), "%02ld:%02ld:%02ld.%03ld [%s] %s",
+            sec / 3600, (sec / 60) % 60, sec % 60, nsec / 1000000,
+            log_level_to_string(slot->level), slot->msg);
+    write_line_to_error_file(line);
+}
+
+static void flush_pending()
+{
+    unsigned int t = atomic_load_explicit(&tail, memory_order_relaxed);
+    unsigned int h = atomic_load_explicit(&head, memory_order_acquire);
+    while (t != h) {
+        write_slot(&slots[t % LOG_SLOT_COUNT]);
+        t++;
+        atomic_store_explicit(&tail, t, memory_order_release);
+    }
+}
+
+static void *flush_loop(void *arg)
+{
+    while (atomic_load(&is_running)) {
+        sem_wait(&pending);
+        flush_pending();
+    }
+    flush_pending();
+    return NULL;
+}
+
+void log_init()
+{
+    if (atomic_load(&is_running))
+        return;
+
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+    sem_init(&pending, 0, 0);
+    atomic_store(&is_running, true);
+    if (pthread_create(&flush_thread, NULL, flush_loop, NULL) != 0) {
+        atomic_store(&is_running, false);
+        sem_destroy(&pending);
+    }
+}
+
+void log_finalize()
+{
+    if (!atomic_load(&is_running))
+        return;
+
+    atomic_store(&is_running, false);
+    sem_post(&pending);
+    pthread_join(flush_thread, NULL);
+    sem_destroy(&pending);
+}
+
+void log_set_level(enum log_level level)
+{
+    if (level < LOG_LEVEL_SILENT)
+        level = LOG_LEVEL_SILENT;
+    if (level > LOG_LEVEL_TRACE)
+        level = LOG_LEVEL_TRACE;
+    log_runtime_level = level;
+}
+
+enum log_level log_get_level()
+{
+    return log_runtime_level;
+}
+
+unsigned long log_get_dropped_count()
+{
+    return atomic_load(&dropped_count);
+}
+
+void _log_print(enum log_level level, const char *fmt, ...)
+{
+    va_list args;
+
+    // without the flush thread we can't defer the write
+    if (!atomic_load(&is_running)) {
+        va_start(args, fmt);
+        fprintf(stderr, "[%s] ", log_level_to_string(level));
+        vfprintf(stderr, fmt, args);
+        fprintf(stderr, "\n");
+        va_end(args);
+        return;
+    }
+
+    unsigned int h = atomic_load_explicit(&head, memory_order_relaxed);
+    unsigned int t = atomic_load_explicit(&tail, memory_order_acquire);
+    if (h - t >= LOG_SLOT_COUNT) {
+        atomic_fetch_add(&dropped_count, 1);
+        return;
+    }
+
+    struct log_slot *slot = &slots[h % LOG_SLOT_COUNT];
+    slot->level = level;
+    clock_gettime(CLOCK_MONOTONIC, &slot->time);
+    va_start(args, fmt);
+    vsnprintf(slot->msg, LOG_MSG_LEN, fmt, args);
+    va_end(args);
+
+    atomic_store_explicit(&head, h + 1, memory_order_release);
+    sem_post(&pending);
+}
@@ -16,6 +16,7 @@
 #include "tile/tileUtils.h"
 #include "options.h"
 #include "server.h"
+#include "utils/bytecodeCache.h"
 #include "utils/writeFile.h"
 #include "stringop.h"
 #include "utils/coreUtils.h"
@@ -25,6 +26,7 @@
 #include "translationLayer.h"
 #include "ipc/ipc-server.h"
 #include "tagset.h"
+#include "lua_watchdog.h"
 
 static const char *plugin_relative_paths[] = {
     "autoload",
@@ -34,6 +36,8 @@ static const char *plugin_relative_paths[] = {
 static const char *config_file = "init.lua";
 static const char *error_file = "init.err";
 static int error_fd = -1;
+// the error file is also written to by the log thread
+static pthread_mutex_t error_fd_lock = PTHREAD_MUTEX_INITIALIZER;
 
 // returns 0 upon success and 1 upon failure
 int load_file(lua_State *L, const char *file)
@@ -42,14 +46,17 @@ int load_file(lua_State *L, const char *file)
         return EXIT_FAILURE;
     }
 
-    if (luaL_loadfile(L, file)) {
+    if (bytecode_cache_loadfile(L, file)) {
         const char *errmsg = luaL_checkstring(L, -1);
         handle_error(errmsg);
         lua_pop(L, 1);
         return EXIT_FAILURE;
     }
 
+    // loading a config file may legitimately take longer than a callback
+    lua_watchdog_suspend();
     int ret = lua_call_safe(L, 0, 0, 0);
+    lua_watchdog_resume();
 
     return ret;
 }
@@ -185,7 +192,8 @@ void load_default_lua_config(lua_State *L)
     g_ptr_array_add(tagnames, "1:2");
     g_ptr_array_add(tagnames, "2:3");
     g_ptr_array_add(tagnames, "3:4");
-    server.default_layout->name = "";
+    free((char *)server.default_layout->name);
+    server.default_layout->name = strdup("");
     load_tags(server_get_tags(), tagnames);
 
     bitset_set(server.previous_bitset, server.previous_tag);
@@ -205,7 +213,7 @@ void load_default_lua_config(lua_State *L)
         tagset_focus_tags(tag, tag->prev_tags);
     }
 
-    ipc_event_tag();
+    ipc_event_tag("reload", NULL, NULL);
 
     arrange();
 }
@@ -252,7 +260,9 @@ void init_error_file()
     mkdir(ef_dir, 0777);
     char *ef = strdup(ef_dir);
     join_path(&ef, error_file);
+    pthread_mutex_lock(&error_fd_lock);
     error_fd = open(ef, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    pthread_mutex_unlock(&error_fd_lock);
     free(ef);
     free(ef_dir);
 }
@@ -260,16 +270,28 @@ void init_error_file()
 void close_error_file()
 {
     assert(error_fd >= 0);
+    pthread_mutex_lock(&error_fd_lock);
     close(error_fd);
     error_fd = -1;
+    pthread_mutex_unlock(&error_fd_lock);
 }
 
 int lua_call_safe(lua_State *L, int nargs, int nresults, int msgh)
 {
+    if (nresults == 0 && lua_watchdog_skip(L, nargs)) {
+        return LUA_OK;
+    }
+
+    lua_watchdog_begin(L, nargs);
     int lua_status = lua_pcall(L, nargs, nresults, msgh);
+    bool aborted = lua_watchdog_end(L, lua_status);
     if (lua_status != LUA_OK) {
-        const char *errmsg = luaL_checkstring(L, -1);
-        handle_error(errmsg);
+        // the watchdog already reported the violation and the config itself
+        // is fine so we don't fall back to the default config
+        if (!aborted) {
+            const char *errmsg = luaL_checkstring(L, -1);
+            handle_error(errmsg);
+        }
         lua_pop(L, 1);
     }
     return lua_status;
@@ -331,19 +353,21 @@ void notify_msg(const char *msg)
 
 void write_to_error_file(const char *msg)
 {
-    if (error_fd < 0)
-        return;
-
-    write_to_file(error_fd, msg);
+    pthread_mutex_lock(&error_fd_lock);
+    if (error_fd >= 0) {
+        write_to_file(error_fd, msg);
+    }
+    pthread_mutex_unlock(&error_fd_lock);
 }
 
 void write_line_to_error_file(const char *msg)
 {
-    if (error_fd < 0)
-        return;
-
-    write_to_file(error_fd, msg);
-    write_to_file(error_fd, "\n");
+    pthread_mutex_lock(&error_fd_lock);
+    if (error_fd >= 0) {
+        write_to_file(error_fd, msg);
+        write_to_file(error_fd, "\n");
+    }
+    pthread_mutex_unlock(&error_fd_lock);
 }
 
 void handle_error(const char *msg)
@@ -353,10 +377,6 @@ void handle_error(const char *msg)
     printf("%s\n", msg);
     load_default_lua_config(L);
 
-    // if error file not initialized
-    if (error_fd < 0)
-        return;
-
     write_line_to_error_file(msg);
 }
 
@@ -367,12 +387,7 @@ void handle_warning(void *user_data, const char *msg, int i)
     char *final_message = g_strconcat("WARNING: ", msg, "\n", NULL);
     printf("%s", final_message);
 
-    // if error file not initialized
-    if (error_fd < 0)
-        return;
-
-    write_to_file(error_fd, msg);
-    write_to_file(error_fd, "\n");
+    write_line_to_error_file(msg);
     free(final_message);
 }
 
@@ -441,13 +456,35 @@ struct rule *get_config_rule(lua_State *L)
     lua_getfield(L, -1, "title");
     const char *title = get_config_str(L, -1);
     lua_pop(L, 1);
+    lua_getfield(L, -1, "match");
+    enum rule_match match = RULE_MATCH_SUBSTRING;
+    if (!lua_isnil(L, -1)) {
+        const char *match_name = get_config_str(L, -1);
+        int res = rule_match_from_string(match_name);
+        // the error aborts the config instead of replacing it while it still
+        // runs
+        if (res < 0) {
+            luaL_error(L, "unknown rule match type: %s", match_name);
+        }
+        match = res;
+    }
+    lua_pop(L, 1);
     lua_getfield(L, -1, "callback");
     int lua_func_ref = 0;
     lua_ref_safe(L, LUA_REGISTRYINDEX, &lua_func_ref);
 
     lua_pop(L, 1);
 
-    struct rule *rule = create_rule(id, title, lua_func_ref);
+    GError *error = NULL;
+    struct rule *rule = create_rule(id, title, match, lua_func_ref, &error);
+    if (!rule) {
+        if (lua_func_ref > 0) {
+            luaL_unref(L, LUA_REGISTRYINDEX, lua_func_ref);
+        }
+        lua_pushfstring(L, "invalid rule regex: %s", error->message);
+        g_error_free(error);
+        lua_error(L);
+    }
     return rule;
 }
 
@@ -12,6 +12,7 @@
 #include "tile/tileUtils.h"
 #include "tag.h"
 #include "subsurface.h"
+#include "utils/log.h"
 
 static void destroyxdeco(struct wl_listener *listener, void *data);
 static void getxdecomode(struct wl_listener *listener, void *data);
@@ -35,7 +36,7 @@ static void getxdecomode(struct wl_listener *listener, void *data)
 
 void create_notify_xdg(struct wl_listener *listener, void *data)
 {
-    printf("create notify xdg\n");
+    log_trace("create notify xdg");
     /* This event is raised when wlr_xdg_shell receives a new xdg surface from a
      * client, either a toplevel (application window) or popup. */
     struct wlr_xdg_surface *xdg_surface = data;
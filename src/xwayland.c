@@ -12,6 +12,7 @@
 #include "tag.h"
 #include "list_sets/focus_stack_set.h"
 #include "tagset.h"
+#include "startup_profile.h"
 
 #if JAPOKWM_HAS_XWAYLAND
 static const char *atom_map[ATOM_LAST] = {
@@ -88,6 +89,8 @@ void handle_xwayland_ready(struct wl_listener *listener, void *data)
         wl_container_of(listener, server, xwayland_ready);
     struct xwayland *xwayland = &server->xwayland;
 
+    startup_event_mark(STARTUP_EVENT_XWAYLAND_READY);
+
     xcb_connection_t *xcb_conn = xcb_connect(NULL, NULL);
     int err = xcb_connection_has_error(xcb_conn);
     if (err) {
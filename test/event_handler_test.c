@@ -14,6 +14,26 @@ void test_emit_signal()
     destroy_event_handler(event_handler);
 }
 
+void test_changed_containers_are_collected_once()
+{
+    struct event_handler *event_handler = create_event_handler();
+    struct container *con1 = (struct container *)0x1;
+    struct container *con2 = (struct container *)0x2;
+
+    event_handler_mark_container(event_handler, con1);
+    event_handler_mark_container(event_handler, con2);
+    event_handler_mark_container(event_handler, con1);
+    g_assert_cmpint(event_handler->changed_containers->len, ==, 2);
+
+    // destroyed containers must not be passed to on_update
+    event_handler_remove_container(event_handler, con1);
+    g_assert_cmpint(event_handler->changed_containers->len, ==, 1);
+    g_assert_true(
+            g_ptr_array_index(event_handler->changed_containers, 0) == con2);
+
+    destroy_event_handler(event_handler);
+}
+
 #define PREFIX "event_handler"
 #define add_test(func) g_test_add_func("/"PREFIX"/"#func, func)
 int main(int argc, char** argv)
@@ -22,6 +42,7 @@ int main(int argc, char** argv)
     g_test_init(&argc, &argv, NULL);
 
     add_test(test_emit_signal);
+    add_test(test_changed_containers_are_collected_once);
 
     return g_test_run();
 }
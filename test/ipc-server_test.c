@@ -0,0 +1,112 @@
+#include <glib.h>
+#include <stdio.h>
+
+#include "bitset/bitset.h"
+#include "client.h"
+#include "container.h"
+#include "ipc/ipc-server.h"
+#include "list_sets/container_stack_set.h"
+#include "server.h"
+#include "tag.h"
+
+static void assert_query_error(const char *selector, const char *error)
+{
+    json_object *reply = ipc_query(selector);
+    json_object *field;
+    g_assert_true(json_object_object_get_ex(reply, "success", &field));
+    g_assert_false(json_object_get_boolean(field));
+    g_assert_true(json_object_object_get_ex(reply, "error", &field));
+    g_assert_cmpstr(json_object_get_string(field), ==, error);
+    json_object_put(reply);
+}
+
+// returns a new reference to the result of a successful query
+static json_object *query_result(const char *selector)
+{
+    json_object *reply = ipc_query(selector);
+    json_object *field;
+    g_assert_true(json_object_object_get_ex(reply, "success", &field));
+    g_assert_true(json_object_get_boolean(field));
+    g_assert_true(json_object_object_get_ex(reply, "result", &field));
+    json_object_get(field);
+    json_object_put(reply);
+    return field;
+}
+
+void ipc_query_focused_without_window_test()
+{
+    init_server();
+
+    json_object *result = query_result("focused");
+    g_assert_null(result);
+}
+
+void ipc_query_unknown_selector_test()
+{
+    init_server();
+
+    assert_query_error("", "empty selector");
+    assert_query_error("nothing", "unknown selector");
+    assert_query_error("tag", "no such tag");
+    assert_query_error("tag/42", "no such tag");
+    assert_query_error("tag/x", "no such tag");
+    assert_query_error("monitor/HDMI-A-1", "no such monitor");
+}
+
+void ipc_query_tag_without_monitor_test()
+{
+    init_server();
+    struct tag *tag = get_tag(0);
+    g_assert_null(tag_get_monitor(tag));
+
+    json_object *result = query_result("tag/0/window_count");
+    g_assert_cmpint(json_object_get_int(result), ==, 0);
+    json_object_put(result);
+
+    result = query_result("tag/0/output");
+    g_assert_null(result);
+
+    assert_query_error("tag/0/unknown_field", "no such field");
+}
+
+void ipc_query_array_index_test()
+{
+    init_server();
+    struct monitor m = {0};
+    struct client c = {
+        .sticky_tags = bitset_create(),
+    };
+    struct container *con = create_container(&c, &m, true);
+    struct tag *tag = get_tag(con->tag_id);
+    g_ptr_array_add(tag->con_set->tiled_containers, con);
+
+    // the monitor of the fake container is on tag 0
+    json_object *result = query_result("tag/0/windows/0/id");
+    g_assert_cmpint(json_object_get_int64(result), ==, con->id);
+    json_object_put(result);
+
+    result = query_result("tag/0/window_count");
+    g_assert_cmpint(json_object_get_int(result), ==, 1);
+    json_object_put(result);
+
+    assert_query_error("tag/0/windows/1", "no such field");
+    assert_query_error("tag/0/windows/-1", "no such field");
+    assert_query_error("tag/0/windows/first", "no such field");
+
+    g_ptr_array_remove(tag->con_set->tiled_containers, con);
+}
+
+#define PREFIX "ipc-server"
+#define add_test(func) g_test_add_func("/"PREFIX"/"#func, func)
+int main(int argc, char **argv)
+{
+    setbuf(stdout, NULL);
+    g_test_init(&argc, &argv, NULL);
+
+    add_test(ipc_query_focused_without_window_test);
+    add_test(ipc_query_unknown_selector_test);
+    add_test(ipc_query_tag_without_monitor_test);
+    add_test(ipc_query_array_index_test);
+
+    return g_test_run();
+}
@@ -172,6 +172,19 @@ void sort_keybinding_test()
     free(res);
 }
 
+void copy_keybinding_test()
+{
+    struct keybinding *keybinding = create_keybinding("mod-1", 0);
+    struct keybinding *copy = copy_keybinding(keybinding, NULL);
+    g_assert_true(copy == keybinding);
+    g_assert_cmpint(keybinding->ref_count, ==, 2);
+
+    destroy_keybinding(copy);
+    g_assert_cmpint(keybinding->ref_count, ==, 1);
+    g_assert_cmpstr(keybinding->binding, ==, "mod-1");
+    destroy_keybinding(keybinding);
+}
+
 #define PREFIX "keybinding"
 #define add_test(func) g_test_add_func("/"PREFIX"/"#func, func)
 int main(int argc, char **argv)
@@ -183,6 +196,7 @@ int main(int argc, char **argv)
     add_test(get_matching_keybinding_test);
     add_test(sort_keybinding_element_test);
     add_test(sort_keybinding_test);
+    add_test(copy_keybinding_test);
 
     return g_test_run();
 }
@@ -129,6 +129,46 @@ void test_deep_copy_table()
     lua_pop(L, 2);
 }
 
+void test_deep_copy_layout_data()
+{
+    lua_State *L = luaL_newstate();
+    luaL_openlibs(L);
+
+    luaL_dostring(L,
+            "return {"
+            "    {{0, 0, 1, 1}},"
+            "    {{0, 0, 0.5, 1}, {0.5, 0, 0.5, 1}},"
+            "    name = 'tile',"
+            "}");
+    // [table]
+    lua_pushcfunction(L, deep_copy_table);
+    lua_pushvalue(L, -2);
+    lua_call(L, 1, 1);
+    // [table, copied_table]
+
+    g_assert_cmpint(lua_rawlen(L, 2), ==, 2);
+    lua_getfield(L, 2, "name");
+    g_assert_cmpstr(lua_tostring(L, -1), ==, "tile");
+    lua_pop(L, 1);
+
+    // copied_table[2][2][1] = 0.7
+    lua_rawgeti(L, 2, 2);
+    lua_rawgeti(L, -1, 2);
+    g_assert_cmpint(lua_rawlen(L, -1), ==, 4);
+    lua_pushnumber(L, 0.7);
+    lua_rawseti(L, -2, 1);
+    lua_pop(L, 2);
+    // [table, copied_table]
+
+    lua_rawgeti(L, 1, 2);
+    lua_rawgeti(L, -1, 2);
+    lua_rawgeti(L, -1, 1);
+    g_assert_cmpfloat(lua_tonumber(L, -1), ==, 0.5);
+    lua_pop(L, 3);
+
+    lua_close(L);
+}
+
 #define PREFIX "layout"
 #define add_test(func) g_test_add_func("/"PREFIX"/"#func, func)
 int main(int argc, char **argv)
@@ -137,6 +177,7 @@ int main(int argc, char **argv)
     g_test_init(&argc, &argv, NULL);
 
     add_test(test_deep_copy_table);
+    add_test(test_deep_copy_layout_data);
 
     return g_test_run();
 }
@@ -0,0 +1,169 @@
+#include <glib.h>
+#include <lauxlib.h>
+#include <lua.h>
+#include <lualib.h>
+#include <stdio.h>
+
+#include "lib/lib_container.h"
+#include "lib/lib_list2D.h"
+
+// the containers are never dereferenced, so fake pointers are enough
+static struct container *cons[] = {
+    (struct container *)0x1,
+    (struct container *)0x2,
+    (struct container *)0x3,
+};
+
+/* a list2D [[con1, con2], [], [con3]] that is available as the global
+ * list */
+static lua_State *create_list2D_state(GPtrArray2D **list)
+{
+    lua_State *L = luaL_newstate();
+    luaL_openlibs(L);
+    lua_load_container(L);
+    lua_load_list2D(L);
+
+    *list = g_ptr_array_new();
+    GPtrArray *first = g_ptr_array_new();
+    g_ptr_array_add(first, cons[0]);
+    g_ptr_array_add(first, cons[1]);
+    g_ptr_array_add(*list, first);
+    g_ptr_array_add(*list, g_ptr_array_new());
+    GPtrArray *last = g_ptr_array_new();
+    g_ptr_array_add(last, cons[2]);
+    g_ptr_array_add(*list, last);
+
+    create_lua_list2D(L, *list);
+    lua_setglobal(L, "list");
+    return L;
+}
+
+static void destroy_list2D_state(lua_State *L, GPtrArray2D *list)
+{
+    lua_close(L);
+    for (int i = 0; i < list->len; i++) {
+        g_ptr_array_unref(g_ptr_array_index(list, i));
+    }
+    g_ptr_array_unref(list);
+}
+
+static void run(lua_State *L, const char *code, int nresults)
+{
+    if (luaL_loadstring(L, code) != LUA_OK
+            || lua_pcall(L, 0, nresults, 0) != LUA_OK) {
+        g_error("%s", lua_tostring(L, -1));
+    }
+}
+
+void lib_list2D_index_test()
+{
+    GPtrArray2D *list;
+    lua_State *L = create_list2D_state(&list);
+
+    run(L, "return list[1], list[2], list[3], list[4], list[0]", 5);
+    g_assert_true(check_container(L, 1) == cons[0]);
+    g_assert_true(check_container(L, 2) == cons[1]);
+    g_assert_true(check_container(L, 3) == cons[2]);
+    g_assert_true(lua_isnil(L, 4));
+    g_assert_true(lua_isnil(L, 5));
+
+    destroy_list2D_state(L, list);
+}
+
+void lib_list2D_pairs_test()
+{
+    GPtrArray2D *list;
+    lua_State *L = create_list2D_state(&list);
+
+    run(L,
+            "local keys, values = {}, {}\n"
+            "for i, con in pairs(list) do\n"
+            "    keys[#keys+1] = i\n"
+            "    values[#values+1] = con\n"
+            "end\n"
+            "return #keys, keys[1], keys[3], values[1], values[2], values[3]",
+            6);
+    g_assert_cmpint(lua_tointeger(L, 1), ==, 3);
+    g_assert_cmpint(lua_tointeger(L, 2), ==, 1);
+    g_assert_cmpint(lua_tointeger(L, 3), ==, 3);
+    g_assert_true(check_container(L, 4) == cons[0]);
+    g_assert_true(check_container(L, 5) == cons[1]);
+    g_assert_true(check_container(L, 6) == cons[2]);
+
+    destroy_list2D_state(L, list);
+}
+
+static GPtrArray2D *removed_from_list = NULL;
+
+static int remove_first(lua_State *L)
+{
+    GPtrArray *first = g_ptr_array_index(removed_from_list, 0);
+    g_ptr_array_remove_index(first, 0);
+    return 0;
+}
+
+void lib_list2D_pairs_snapshot_test()
+{
+    GPtrArray2D *list;
+    lua_State *L = create_list2D_state(&list);
+    removed_from_list = list;
+    lua_register(L, "remove_first", remove_first);
+
+    // removing an element in the loop doesn't skip the next one
+    run(L,
+            "local values = {}\n"
+            "for i, con in pairs(list) do\n"
+            "    if i == 1 then remove_first() end\n"
+            "    values[#values+1] = con\n"
+            "end\n"
+            "return #values, values[2], #list",
+            3);
+    g_assert_cmpint(lua_tointeger(L, 1), ==, 3);
+    g_assert_true(check_container(L, 2) == cons[1]);
+    g_assert_cmpint(lua_tointeger(L, 3), ==, 2);
+
+    removed_from_list = NULL;
+    destroy_list2D_state(L, list);
+}
+
+void lib_list2D_length_test()
+{
+    GPtrArray2D *list;
+    lua_State *L = create_list2D_state(&list);
+
+    run(L, "return #list", 1);
+    g_assert_cmpint(lua_tointeger(L, 1), ==, 3);
+
+    destroy_list2D_state(L, list);
+}
+
+void lib_list2D_to_table_test()
+{
+    GPtrArray2D *list;
+    lua_State *L = create_list2D_state(&list);
+
+    run(L, "local t = list:to_table() return type(t), #t, t[1], t[2], t[3]", 5);
+    g_assert_cmpstr(lua_tostring(L, 1), ==, "table");
+    g_assert_cmpint(lua_tointeger(L, 2), ==, 3);
+    g_assert_true(check_container(L, 3) == cons[0]);
+    g_assert_true(check_container(L, 4) == cons[1]);
+    g_assert_true(check_container(L, 5) == cons[2]);
+
+    destroy_list2D_state(L, list);
+}
+
+#define PREFIX "lib_list2D"
+#define add_test(func) g_test_add_func("/"PREFIX"/"#func, func)
+int main(int argc, char **argv)
+{
+    setbuf(stdout, NULL);
+    g_test_init(&argc, &argv, NULL);
+
+    add_test(lib_list2D_index_test);
+    add_test(lib_list2D_pairs_test);
+    add_test(lib_list2D_pairs_snapshot_test);
+    add_test(lib_list2D_length_test);
+    add_test(lib_list2D_to_table_test);
+
+    return g_test_run();
+}
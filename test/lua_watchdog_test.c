@@ -0,0 +1,110 @@
+#include <glib.h>
+#include <lua.h>
+#include <lauxlib.h>
+
+#include "lua_watchdog.h"
+#include "options.h"
+#include "server.h"
+#include "utils/parseConfigUtils.h"
+
+static void push_function(const char *code)
+{
+    luaL_dostring(L, code);
+}
+
+void test_runaway_callback_is_aborted()
+{
+    struct options *options = server.default_layout->options;
+    options->callback_instruction_limit = 10000;
+    options->callback_time_limit = 0;
+
+    uint64_t violations = server.stats.lua.budget_violations;
+    int top = lua_gettop(L);
+
+    push_function("return function() while true do end end");
+    int status = lua_call_safe(L, 0, 0, 0);
+
+    g_assert_cmpint(status, !=, LUA_OK);
+    g_assert_cmpint(server.stats.lua.budget_violations, ==, violations + 1);
+    // the watchdog must not leave anything on the stack
+    g_assert_cmpint(lua_gettop(L), ==, top);
+    // the config must not be replaced by the default config
+    g_assert_cmpint(options->callback_instruction_limit, ==, 10000);
+}
+
+void test_pcall_cant_swallow_abort()
+{
+    struct options *options = server.default_layout->options;
+    options->callback_instruction_limit = 10000;
+    options->callback_time_limit = 0;
+
+    push_function(
+            "return function()"
+            "    while true do"
+            "        pcall(function() while true do end end)"
+            "    end "
+            "end");
+    int status = lua_call_safe(L, 0, 0, 0);
+
+    g_assert_cmpint(status, !=, LUA_OK);
+}
+
+void test_cheap_callback_is_not_aborted()
+{
+    struct options *options = server.default_layout->options;
+    options->callback_instruction_limit = 10000;
+    options->callback_time_limit = 0;
+
+    push_function("return function(a, b) return a + b end");
+    lua_pushinteger(L, 1);
+    lua_pushinteger(L, 2);
+    int status = lua_call_safe(L, 2, 1, 0);
+
+    g_assert_cmpint(status, ==, LUA_OK);
+    g_assert_cmpint(lua_tointeger(L, -1), ==, 3);
+    lua_pop(L, 1);
+}
+
+void test_demoted_callback_is_skipped()
+{
+    struct options *options = server.default_layout->options;
+    options->callback_instruction_limit = 10000;
+    options->callback_time_limit = 0;
+    options->callback_demote_threshold = 2;
+    lua_watchdog_reset();
+
+    luaL_dostring(L, "runaway = function(x) while true do end end");
+    uint64_t skipped = server.stats.lua.skipped_calls;
+    int top = lua_gettop(L);
+
+    for (int i = 0; i < 2; i++) {
+        lua_getglobal(L, "runaway");
+        lua_pushinteger(L, i);
+        g_assert_cmpint(lua_call_safe(L, 1, 0, 0), !=, LUA_OK);
+    }
+    g_assert_cmpint(server.stats.lua.skipped_calls, ==, skipped);
+
+    lua_getglobal(L, "runaway");
+    lua_pushinteger(L, 2);
+    g_assert_cmpint(lua_call_safe(L, 1, 0, 0), ==, LUA_OK);
+    g_assert_cmpint(server.stats.lua.skipped_calls, ==, skipped + 1);
+    g_assert_cmpint(lua_gettop(L), ==, top);
+
+    lua_watchdog_reset();
+}
+
+#define PREFIX "lua_watchdog"
+#define add_test(func) g_test_add_func("/"PREFIX"/"#func, func)
+int main(int argc, char **argv)
+{
+    setbuf(stdout, NULL);
+    g_test_init(&argc, &argv, NULL);
+    init_server();
+
+    add_test(test_runaway_callback_is_aborted);
+    add_test(test_pcall_cant_swallow_abort);
+    add_test(test_cheap_callback_is_not_aborted);
+    add_test(test_demoted_callback_is_skipped);
+
+    return g_test_run();
+}
@@ -0,0 +1,115 @@
+#include <glib.h>
+#include <json.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "msgpack.h"
+
+static json_object *roundtrip(json_object *object, guint *len)
+{
+    GByteArray *encoded = g_byte_array_new();
+    msgpack_encode(encoded, object);
+    *len = encoded->len;
+
+    bool error = true;
+    json_object *decoded = msgpack_decode(encoded->data, encoded->len, &error);
+    g_assert_false(error);
+    g_byte_array_unref(encoded);
+    return decoded;
+}
+
+void msgpack_roundtrip_int_test()
+{
+    const int64_t ints[] = {0, 127, 128, 65536, INT64_MAX, -1, -32, -33,
+        -129, INT32_MIN, INT64_MIN};
+    const guint lengths[] = {1, 1, 2, 5, 9, 1, 1, 2, 3, 5, 9};
+
+    for (int i = 0; i < sizeof(ints) / sizeof(ints[0]); i++) {
+        json_object *object = json_object_new_int64(ints[i]);
+        guint len;
+        json_object *decoded = roundtrip(object, &len);
+        g_assert_cmpint(json_object_get_int64(decoded), ==, ints[i]);
+        g_assert_cmpuint(len, ==, lengths[i]);
+        json_object_put(object);
+        json_object_put(decoded);
+    }
+}
+
+void msgpack_roundtrip_object_test()
+{
+    const char *json =
+        "{\"name\": \"1:1\", \"id\": 3, \"focused\": true, \"urgent\": false,"
+        " \"ratio\": 0.5, \"app_id\": null, \"rect\": {\"x\": -10, \"y\": 20,"
+        " \"width\": 1920, \"height\": 1080}, \"nodes\": [1, \"two\", [], {}]}";
+    json_object *object = json_tokener_parse(json);
+
+    guint len;
+    json_object *decoded = roundtrip(object, &len);
+    g_assert_true(json_object_equal(object, decoded));
+    g_assert_cmpuint(len, <, strlen(json));
+
+    json_object_put(object);
+    json_object_put(decoded);
+}
+
+void msgpack_roundtrip_long_string_test()
+{
+    char *str = g_strnfill(70000, 'x');
+    json_object *object = json_object_new_string(str);
+
+    guint len;
+    json_object *decoded = roundtrip(object, &len);
+    g_assert_cmpstr(json_object_get_string(decoded), ==, str);
+    g_assert_cmpuint(len, ==, 70000 + 5);
+
+    json_object_put(object);
+    json_object_put(decoded);
+    g_free(str);
+}
+
+void msgpack_decode_invalid_test()
+{
+    bool error;
+
+    const uint8_t nil[] = {0xc0};
+    g_assert_null(msgpack_decode(nil, sizeof(nil), &error));
+    g_assert_false(error);
+
+    // an array of two elements with only one of them
+    const uint8_t truncated[] = {0x92, 0x01};
+    g_assert_null(msgpack_decode(truncated, sizeof(truncated), &error));
+    g_assert_true(error);
+
+    const uint8_t trailing[] = {0x01, 0x02};
+    g_assert_null(msgpack_decode(trailing, sizeof(trailing), &error));
+    g_assert_true(error);
+
+    const uint8_t int_key[] = {0x81, 0x01, 0x01};
+    g_assert_null(msgpack_decode(int_key, sizeof(int_key), &error));
+    g_assert_true(error);
+
+    // a huge array without elements must not allocate them
+    const uint8_t huge[] = {0xdd, 0xff, 0xff, 0xff, 0xff};
+    g_assert_null(msgpack_decode(huge, sizeof(huge), &error));
+    g_assert_true(error);
+
+    uint8_t deep[1000];
+    memset(deep, 0x91, sizeof(deep));
+    g_assert_null(msgpack_decode(deep, sizeof(deep), &error));
+    g_assert_true(error);
+}
+
+#define PREFIX "msgpack"
+#define add_test(func) g_test_add_func("/"PREFIX"/"#func, func)
+int main(int argc, char **argv)
+{
+    setbuf(stdout, NULL);
+    g_test_init(&argc, &argv, NULL);
+
+    add_test(msgpack_roundtrip_int_test);
+    add_test(msgpack_roundtrip_object_test);
+    add_test(msgpack_roundtrip_long_string_test);
+    add_test(msgpack_decode_invalid_test);
+
+    return g_test_run();
+}
@@ -0,0 +1,110 @@
+#include <glib.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "client.h"
+#include "container.h"
+#include "ipc/ipc-server.h"
+#include "server.h"
+#include "tile/tileUtils.h"
+#include "transaction.h"
+
+void transaction_nested_test()
+{
+    init_server();
+    uint64_t transactions = server.stats.ipc.transactions;
+
+    g_assert_false(transaction_is_active());
+    transaction_begin();
+    transaction_begin();
+    g_assert_true(transaction_is_active());
+    transaction_commit();
+    // only the outermost commit ends the transaction
+    g_assert_true(transaction_is_active());
+    transaction_commit();
+    g_assert_false(transaction_is_active());
+
+    g_assert_cmpuint(server.stats.ipc.transactions, ==, transactions + 1);
+}
+
+void transaction_deferred_arrange_test()
+{
+    init_server();
+    uint64_t deferred = server.stats.ipc.deferred_arranges;
+
+    g_assert_false(transaction_defer_arrange());
+
+    transaction_begin();
+    arrange();
+    arrange();
+    transaction_begin();
+    arrange();
+    transaction_commit();
+    transaction_commit();
+    // the first arrange is pending, the others are merged into it
+    g_assert_cmpuint(server.stats.ipc.deferred_arranges, ==, deferred + 2);
+
+    // the commit arranged, so the next transaction starts without one
+    transaction_begin();
+    arrange();
+    transaction_commit();
+    g_assert_cmpuint(server.stats.ipc.deferred_arranges, ==, deferred + 2);
+}
+
+void transaction_pending_events_are_deduplicated_test()
+{
+    init_server();
+
+    transaction_begin();
+    ipc_event_tag("focus", NULL, NULL);
+    ipc_event_tag("focus", NULL, NULL);
+    ipc_event_tag("rename", NULL, NULL);
+    g_assert_cmpuint(ipc_events_pending_count(), ==, 2);
+    transaction_commit();
+
+    g_assert_cmpuint(ipc_events_pending_count(), ==, 0);
+}
+
+void transaction_close_event_skips_earlier_events_test()
+{
+    init_server();
+
+    struct client *c = calloc(1, sizeof(*c));
+    struct container *con = calloc(1, sizeof(*con));
+    con->id = 42;
+    con->client = c;
+    g_ptr_array_add(server.container_stack, con);
+
+    transaction_begin();
+    ipc_event_window("focus", con);
+    ipc_event_window("title", con);
+    ipc_event_window("focus", con);
+    ipc_event_window("close", con);
+    ipc_event_window("close", con);
+    g_assert_cmpuint(ipc_events_pending_count(), ==, 3);
+
+    // the container is destroyed before the commit. The focus and title
+    // events must be skipped instead of describing the freed container, the
+    // close event was described while it still existed
+    g_ptr_array_remove(server.container_stack, con);
+    free(con);
+    free(c);
+    transaction_commit();
+
+    g_assert_cmpuint(ipc_events_pending_count(), ==, 0);
+}
+
+#define PREFIX "transaction"
+#define add_test(func) g_test_add_func("/"PREFIX"/"#func, func)
+int main(int argc, char **argv)
+{
+    setbuf(stdout, NULL);
+    g_test_init(&argc, &argv, NULL);
+
+    add_test(transaction_nested_test);
+    add_test(transaction_deferred_arrange_test);
+    add_test(transaction_pending_events_are_deduplicated_test);
+    add_test(transaction_close_event_skips_earlier_events_test);
+
+    return g_test_run();
+}
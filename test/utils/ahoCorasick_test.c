@@ -0,0 +1,83 @@
+#include <glib.h>
+
+#include "utils/ahoCorasick.h"
+
+struct match {
+    int id;
+    size_t start;
+    size_t end;
+};
+
+static void add_match(int id, size_t start, size_t end, void *data)
+{
+    GArray *matches = data;
+    struct match match = {.id = id, .start = start, .end = end};
+    g_array_append_val(matches, match);
+}
+
+static GArray *find_matches(struct aho_corasick *ac, const char *text)
+{
+    GArray *matches = g_array_new(false, false, sizeof(struct match));
+    aho_corasick_match(ac, text, add_match, matches);
+    return matches;
+}
+
+static void assert_match(GArray *matches, int i, int id, size_t start, size_t end)
+{
+    struct match *match = &g_array_index(matches, struct match, i);
+    g_assert_cmpint(match->id, ==, id);
+    g_assert_cmpint(match->start, ==, start);
+    g_assert_cmpint(match->end, ==, end);
+}
+
+void test_overlapping_patterns()
+{
+    struct aho_corasick *ac = create_aho_corasick();
+    aho_corasick_add(ac, "he", 0);
+    aho_corasick_add(ac, "she", 1);
+    aho_corasick_add(ac, "his", 2);
+    aho_corasick_add(ac, "hers", 3);
+    aho_corasick_build(ac);
+
+    GArray *matches = find_matches(ac, "ushers");
+    g_assert_cmpint(matches->len, ==, 3);
+    assert_match(matches, 0, 1, 1, 4);
+    assert_match(matches, 1, 0, 2, 4);
+    assert_match(matches, 2, 3, 2, 6);
+    g_array_unref(matches);
+
+    matches = find_matches(ac, "firefox");
+    g_assert_cmpint(matches->len, ==, 0);
+    g_array_unref(matches);
+
+    destroy_aho_corasick(ac);
+}
+
+void test_duplicate_patterns()
+{
+    struct aho_corasick *ac = create_aho_corasick();
+    aho_corasick_add(ac, "fox", 0);
+    aho_corasick_add(ac, "fox", 1);
+    aho_corasick_build(ac);
+
+    GArray *matches = find_matches(ac, "firefox");
+    g_assert_cmpint(matches->len, ==, 2);
+    assert_match(matches, 0, 0, 4, 7);
+    assert_match(matches, 1, 1, 4, 7);
+    g_array_unref(matches);
+
+    destroy_aho_corasick(ac);
+}
+
+#define PREFIX "aho_corasick"
+#define add_test(func) g_test_add_func("/"PREFIX"/"#func, func)
+int main(int argc, char **argv)
+{
+    setbuf(stdout, NULL);
+    g_test_init(&argc, &argv, NULL);
+
+    add_test(test_overlapping_patterns);
+    add_test(test_duplicate_patterns);
+
+    return g_test_run();
+}
@@ -0,0 +1,79 @@
+#include <fcntl.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <lauxlib.h>
+#include <lua.h>
+#include <lualib.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include "utils/bytecodeCache.h"
+
+static int load_and_call(lua_State *L, const char *file)
+{
+    g_assert_cmpint(bytecode_cache_loadfile(L, file), ==, LUA_OK);
+    lua_call(L, 0, 1);
+    int result = lua_tointeger(L, -1);
+    lua_pop(L, 1);
+    return result;
+}
+
+static void set_mtime(const char *file, struct timespec mtime)
+{
+    struct timespec times[2] = {mtime, mtime};
+    g_assert_cmpint(utimensat(AT_FDCWD, file, times, 0), ==, 0);
+}
+
+void test_cache_is_used_and_invalidated()
+{
+    char *dir = g_dir_make_tmp("japokwm_cache_XXXXXX", NULL);
+    g_assert_nonnull(dir);
+    setenv("XDG_CACHE_HOME", dir, true);
+
+    char *file = g_build_filename(dir, "init.lua", NULL);
+    g_assert_true(g_file_set_contents(file, "return 1", -1, NULL));
+
+    lua_State *L = luaL_newstate();
+    luaL_openlibs(L);
+
+    g_assert_cmpint(load_and_call(L, file), ==, 1);
+    char *cache_path = bytecode_cache_get_path(file);
+    g_assert_true(g_file_test(cache_path, G_FILE_TEST_EXISTS));
+
+    // same size and modification time: the cached chunk is used
+    struct stat st;
+    g_assert_cmpint(stat(file, &st), ==, 0);
+    g_assert_true(g_file_set_contents(file, "return 2", -1, NULL));
+    set_mtime(file, st.st_mtim);
+    g_assert_cmpint(load_and_call(L, file), ==, 1);
+
+    // a different modification time invalidates the cache
+    struct timespec mtime = st.st_mtim;
+    mtime.tv_sec += 1;
+    set_mtime(file, mtime);
+    g_assert_cmpint(load_and_call(L, file), ==, 2);
+    g_assert_cmpint(load_and_call(L, file), ==, 2);
+
+    lua_close(L);
+    g_unlink(cache_path);
+    g_unlink(file);
+    char *cache_dir = g_path_get_dirname(cache_path);
+    g_rmdir(cache_dir);
+    g_rmdir(dir);
+    g_free(cache_dir);
+    g_free(cache_path);
+    g_free(file);
+    g_free(dir);
+}
+
+#define PREFIX "bytecode_cache"
+#define add_test(func) g_test_add_func("/"PREFIX"/"#func, func)
+int main(int argc, char **argv)
+{
+    setbuf(stdout, NULL);
+    g_test_init(&argc, &argv, NULL);
+
+    add_test(test_cache_is_used_and_invalidated);
+
+    return g_test_run();
+}
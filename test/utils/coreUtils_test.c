@@ -269,6 +269,28 @@ void test_list_insert()
     g_ptr_array_unref(list);
 }
 
+void string_lists_equal_test()
+{
+    GPtrArray *list1 = g_ptr_array_new();
+    GPtrArray *list2 = g_ptr_array_new();
+    g_assert_true(string_lists_equal(list1, list2));
+
+    g_ptr_array_add(list1, "1");
+    g_ptr_array_add(list1, "2");
+    g_assert_false(string_lists_equal(list1, list2));
+
+    g_ptr_array_add(list2, "1");
+    g_ptr_array_add(list2, "3");
+    g_assert_false(string_lists_equal(list1, list2));
+
+    g_ptr_array_remove_index(list2, 1);
+    g_ptr_array_add(list2, "2");
+    g_assert_true(string_lists_equal(list1, list2));
+
+    g_ptr_array_unref(list1);
+    g_ptr_array_unref(list2);
+}
+
 #define PREFIX "coreUtils"
 #define add_test(func) g_test_add_func("/"PREFIX"/"#func, func)
 int main(int argc, char **argv)
@@ -284,6 +306,7 @@ int main(int argc, char **argv)
     add_test(cross_sum_test);
     add_test(get_relative_item_in_list_test);
     add_test(lower_bound_test);
+    add_test(string_lists_equal_test);
 
     return g_test_run();
 }
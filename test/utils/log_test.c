@@ -0,0 +1,45 @@
+#include <stdlib.h>
+#include <glib.h>
+
+#include "utils/log.h"
+
+void test_set_level_is_clamped()
+{
+    log_set_level(LOG_LEVEL_TRACE + 3);
+    g_assert_cmpint(log_get_level(), ==, LOG_LEVEL_TRACE);
+    log_set_level(-1);
+    g_assert_cmpint(log_get_level(), ==, LOG_LEVEL_SILENT);
+    log_set_level(LOG_LEVEL_INFO);
+    g_assert_cmpint(log_get_level(), ==, LOG_LEVEL_INFO);
+}
+
+void test_level_to_string()
+{
+    g_assert_cmpstr(log_level_to_string(LOG_LEVEL_ERROR), ==, "ERROR");
+    g_assert_cmpstr(log_level_to_string(LOG_LEVEL_TRACE), ==, "TRACE");
+    g_assert_cmpstr(log_level_to_string(LOG_LEVEL_TRACE + 1), ==, "UNKNOWN");
+}
+
+void test_messages_below_level_are_not_formatted()
+{
+    int calls = 0;
+    log_set_level(LOG_LEVEL_ERROR);
+    // the arguments must not be evaluated if the message is dropped
+    log_debug("%d", ++calls);
+    g_assert_cmpint(calls, ==, 0);
+    log_set_level(LOG_LEVEL_INFO);
+}
+
+#define PREFIX "log"
+#define add_test(func) g_test_add_func("/"PREFIX"/"#func, func)
+int main(int argc, char **argv)
+{
+    setbuf(stdout, NULL);
+    g_test_init(&argc, &argv, NULL);
+
+    add_test(test_set_level_is_clamped);
+    add_test(test_level_to_string);
+    add_test(test_messages_below_level_are_not_formatted);
+
+    return g_test_run();
+}